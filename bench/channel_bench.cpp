@@ -0,0 +1,221 @@
+// Channel throughput: spsc_channel between two coroutines on one worker, and
+// mpsc_channel with senders on several workers against posting each message
+// through the Mailbox.
+//
+// Usage: ./channel_bench [messages] [max_senders]
+//
+//  - spsc: a sender coroutine pushes `messages` integers to a receiver coroutine on
+//    the same worker, for a few channel capacities. A full or empty channel parks the
+//    blocked side on the ready queue.
+//  - mpsc: 1, 2, 4, ... sender workers each push messages / senders integers to one
+//    receiver worker through a 1024-slot channel. A blocked receiver is woken by
+//    MSG_RING once per sleep, not once per message. The baseline posts one Mailbox
+//    message per integer instead.
+
+#include "io/include/io_uring.h"
+#include "io/include/mailbox.h"
+#include "io/include/channel.h"
+#include "io/include/scheduler.h"
+#include "io/include/logger.h"
+#include "coroutine/include/task.h"
+#include "coroutine/include/spawn.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    task<void> spsc_sender(spsc_channel<std::uint64_t> &channel, std::size_t messages)
+    {
+        for (std::uint64_t i = 0; i < messages; ++i)
+        {
+            co_await channel.send(i);
+        }
+        channel.close();
+    }
+
+    task<void> spsc_receiver(spsc_channel<std::uint64_t> &channel, std::uint64_t &checksum)
+    {
+        while (auto value = co_await channel.recv())
+        {
+            checksum += *value;
+        }
+        IoUring::getInstance().stop();
+    }
+
+    void run_spsc(std::size_t capacity, std::size_t messages)
+    {
+        std::uint64_t checksum = 0;
+        double seconds = 0;
+        std::thread worker([&]
+                           {
+            auto &ring = IoUring::getInstance();
+            if (ring.queueInit() != 0)
+            {
+                std::fprintf(stderr, "queueInit failed\n");
+                return;
+            }
+            spsc_channel<std::uint64_t> channel{capacity};
+            const auto start = std::chrono::steady_clock::now();
+            spawn(spsc_receiver(channel, checksum));
+            spawn(spsc_sender(channel, messages));
+            ring.eventLoop();
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); });
+        worker.join();
+
+        const std::uint64_t expected = static_cast<std::uint64_t>(messages) * (messages - 1) / 2;
+        std::printf("spsc capacity %-6zu %12.1f Mmsg/s%s\n", capacity, static_cast<double>(messages) / seconds / 1e6,
+                    checksum == expected ? "" : "  (checksum mismatch)");
+    }
+
+    struct mpsc_state
+    {
+        mpsc_channel<std::uint64_t> channel;
+        std::size_t expected = 0;
+        std::size_t received = 0;
+        std::uint64_t checksum = 0;
+    };
+
+    task<void> mpsc_sender(mpsc_state &state, std::size_t messages)
+    {
+        // Start from the event loop, so stop() below is not undone by the loop starting
+        co_await yield();
+        for (std::uint64_t i = 0; i < messages; ++i)
+        {
+            co_await state.channel.send(i);
+        }
+        // The last wakeup may still sit in the SQ, and the loop will not come round again
+        IoUring::getInstance().submit();
+        IoUring::getInstance().stop();
+    }
+
+    task<void> mpsc_receiver(mpsc_state &state)
+    {
+        co_await yield();
+        while (state.received < state.expected)
+        {
+            auto value = co_await state.channel.recv();
+            if (!value)
+            {
+                break;
+            }
+            state.checksum += *value;
+            ++state.received;
+        }
+        IoUring::getInstance().stop();
+    }
+
+    task<void> mailbox_sender(std::size_t &received, std::size_t expected, std::size_t messages)
+    {
+        co_await yield();
+        for (std::size_t i = 0; i < messages; ++i)
+        {
+            Mailbox::post(0, [&received, expected]
+                          {
+                if (++received == expected)
+                {
+                    IoUring::getInstance().stop();
+                } });
+        }
+        IoUring::getInstance().submit();
+        IoUring::getInstance().stop();
+    }
+
+    // Worker 0 receives, workers 1..senders send; returns messages per second
+    template <typename Receiver, typename Sender>
+    double run_workers(std::size_t senders, Receiver receiver, Sender sender)
+    {
+        std::latch attached{static_cast<std::ptrdiff_t>(senders + 1)};
+        std::latch started{1};
+        std::vector<std::thread> threads;
+
+        auto body = [&](std::size_t index)
+        {
+            auto &ring = IoUring::getInstance();
+            if (ring.queueInit() != 0)
+            {
+                std::fprintf(stderr, "queueInit failed\n");
+                attached.count_down();
+                return;
+            }
+            Mailbox::getInstance().attach(index);
+            attached.count_down();
+            started.wait();
+            if (index == 0)
+            {
+                receiver();
+            }
+            else
+            {
+                sender(index);
+            }
+            ring.eventLoop();
+            Mailbox::getInstance().detach();
+        };
+
+        for (std::size_t i = 0; i <= senders; ++i)
+        {
+            threads.emplace_back(body, i);
+        }
+        attached.wait();
+        const auto start = std::chrono::steady_clock::now();
+        started.count_down();
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void run_mpsc(std::size_t senders, std::size_t messages)
+    {
+        const std::size_t per_sender = messages / senders;
+
+        mpsc_state state;
+        state.expected = per_sender * senders;
+        const double channel_seconds = run_workers(
+            senders, [&] { spawn(mpsc_receiver(state)); },
+            [&](std::size_t) { spawn(mpsc_sender(state, per_sender)); });
+
+        // Baseline: one Mailbox message (std::function + queue node) per integer
+        std::size_t received = 0;
+        const double mailbox_seconds = run_workers(
+            senders, [] {}, [&](std::size_t) { spawn(mailbox_sender(received, state.expected, per_sender)); });
+
+        const double total = static_cast<double>(state.expected);
+        std::printf("%8zu %14.1f %14.1f%s\n", senders, total / channel_seconds / 1e6, total / mailbox_seconds / 1e6,
+                    state.received == state.expected ? "" : "  (lost messages)");
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t messages = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+    const std::size_t max_senders = argc > 2 ? std::stoul(argv[2])
+                                             : std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1);
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("%zu messages\n", messages);
+    for (std::size_t capacity : {16, 256, 4096})
+    {
+        run_spsc(capacity, messages);
+    }
+
+    std::printf("\n%8s %14s %14s\n", "senders", "mpsc Mmsg/s", "mailbox Mmsg/s");
+    for (std::size_t senders = 1; senders <= max_senders; senders *= 2)
+    {
+        run_mpsc(senders, messages);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Per-packet cost of the heartbeat + log timestamp path, with and without the cached
+// per-worker clock.
+//
+// Usage: ./clock_bench [packets]
+//
+// Every packet updates a heartbeat time_point and stamps and renders one log line
+// prefix, as GameSession::OnRecvData does with a synchronous logger.
+//  - legacy: steady_clock::now() for the heartbeat, then system_clock::now(), localtime()
+//    and put_time through an ostringstream per line (the old Logger::getCurrentTime).
+//  - precise: the current code on a thread whose clock is never refreshed, i.e. two
+//    clock reads per packet and a per-second cached date.
+//  - coarse/N: CoarseClock::refresh() once per N packets, as the event loop does once
+//    per CQE batch; the packets in between read the cached time, and the first line in
+//    a new millisecond renders the text the others reuse.
+
+#include "io/include/coarse_clock.h"
+#include "io/include/log_backend.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace co_uring;
+
+namespace
+{
+
+    template <typename T>
+    inline void keep(T &value)
+    {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    std::string legacyTimestamp()
+    {
+        auto now = std::chrono::system_clock::now();
+        auto time_t = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+
+        std::ostringstream oss;
+        oss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+        oss << "." << std::setfill('0') << std::setw(3) << ms.count();
+        return oss.str();
+    }
+
+    // Runs body on a fresh thread, so each variant starts with its own (inactive) clock
+    template <typename Body>
+    double measure(std::size_t packets, Body body)
+    {
+        double ns = 0;
+        std::thread([&]
+                    {
+            const auto start = std::chrono::steady_clock::now();
+            body(packets);
+            ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                 static_cast<double>(packets); })
+            .join();
+        return ns;
+    }
+
+    // What the synchronous logger does per line: stamp the record, then render the prefix
+    void renderLine(std::string &line)
+    {
+        log_record record;
+        LogBackend::stamp(record, LogLevel::DEBUG, __FILE__, __LINE__, __FUNCTION__);
+        line.clear();
+        LogBackend::render(line, record, "📥 데이터 수신", "0001", false);
+        keep(line);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t packets = argc > 1 ? std::stoul(argv[1]) : 5'000'000;
+
+    const double legacy = measure(packets, [](std::size_t count)
+                                  {
+        std::chrono::steady_clock::time_point heartbeat;
+        std::string line;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            heartbeat = std::chrono::steady_clock::now();
+            line = legacyTimestamp();
+            keep(heartbeat);
+            keep(line);
+        } });
+
+    const double precise = measure(packets, [](std::size_t count)
+                                   {
+        std::chrono::steady_clock::time_point heartbeat;
+        std::string line;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            heartbeat = CoarseClock::getInstance().now();
+            renderLine(line);
+            keep(heartbeat);
+        } });
+
+    std::printf("%-12s %10.1f ns/packet\n", "legacy", legacy);
+    std::printf("%-12s %10.1f ns/packet\n", "precise", precise);
+
+    for (std::size_t batch : {1, 16, 64})
+    {
+        const double coarse = measure(packets, [batch](std::size_t count)
+                                      {
+            auto &clock = CoarseClock::getInstance();
+            std::chrono::steady_clock::time_point heartbeat;
+            std::string line;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (i % batch == 0)
+                {
+                    clock.refresh();
+                }
+                heartbeat = clock.now();
+                renderLine(line);
+                keep(heartbeat);
+            } });
+        std::printf("coarse/%-5zu %10.1f ns/packet\n", batch, coarse);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Completions per second through IoUring::eventLoop() with different CQE budgets,
+// against a per-CQE io_uring_cqe_seen loop as the old reaping path.
+//
+// Usage: ./cqe_reap_bench [completions] [in_flight]
+//
+// Every completion re-submits a NOP until the target count is reached, so the
+// numbers measure reaping/dispatch overhead rather than any real I/O.
+
+#include "io/include/io_uring.h"
+#include "io/include/logger.h"
+#include <liburing.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    struct nop_flood
+    {
+        std::uint64_t target = 0;
+        std::uint64_t submitted = 0;
+        std::uint64_t completed = 0;
+    };
+
+    nop_flood *current_flood = nullptr;
+
+    void on_nop_complete(sqe_data *data)
+    {
+        auto &flood = *current_flood;
+        ++flood.completed;
+        if (flood.submitted < flood.target)
+        {
+            ++flood.submitted;
+            IoUring::getInstance().submitNopRequest(data);
+        }
+        else if (flood.completed == flood.target)
+        {
+            IoUring::getInstance().stop();
+        }
+    }
+
+    double run_event_loop(std::uint64_t completions, std::uint32_t in_flight, std::uint32_t budget)
+    {
+        double rate = 0.0;
+        // Fresh thread so the thread_local ring is initialised with this budget
+        std::thread runner([&]()
+                           {
+            IoUringOptions options;
+            options.cqe_budget = budget;
+            auto &ring = IoUring::getInstance();
+            if (ring.queueInit(options) != 0)
+            {
+                return;
+            }
+
+            nop_flood flood;
+            flood.target = completions;
+            current_flood = &flood;
+
+            std::vector<sqe_data> slots(in_flight);
+            for (auto &slot : slots)
+            {
+                slot.on_complete = &on_nop_complete;
+                ++flood.submitted;
+                ring.submitNopRequest(&slot);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            ring.eventLoop();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            rate = static_cast<double>(flood.completed) / elapsed.count(); });
+        runner.join();
+        return rate;
+    }
+
+    double run_per_cqe_seen(std::uint64_t completions, std::uint32_t in_flight)
+    {
+        io_uring ring;
+        io_uring_params params = {};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = IoUring::CQ_SIZE;
+        if (io_uring_queue_init_params(IoUring::IO_URING_QUEUE_SIZE, &ring, &params) < 0)
+        {
+            return 0.0;
+        }
+
+        std::vector<sqe_data> slots(in_flight);
+        std::uint64_t submitted = 0;
+        std::uint64_t completed = 0;
+        for (auto &slot : slots)
+        {
+            io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+            io_uring_prep_nop(sqe);
+            io_uring_sqe_set_data(sqe, &slot);
+            ++submitted;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        while (completed < completions)
+        {
+            io_uring_submit_and_wait(&ring, 1);
+
+            std::uint32_t head = 0;
+            io_uring_cqe *cqe = nullptr;
+            io_uring_for_each_cqe(&ring, head, cqe)
+            {
+                auto *data = reinterpret_cast<sqe_data *>(io_uring_cqe_get_data(cqe));
+                data->cqe_res = cqe->res;
+                data->cqe_flags = cqe->flags;
+                io_uring_cqe_seen(&ring, cqe);
+                ++completed;
+
+                if (submitted < completions)
+                {
+                    io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+                    io_uring_prep_nop(sqe);
+                    io_uring_sqe_set_data(sqe, data);
+                    ++submitted;
+                }
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        io_uring_queue_exit(&ring);
+        return static_cast<double>(completed) / elapsed.count();
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::uint64_t completions = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    const std::uint32_t in_flight = argc > 2 ? static_cast<std::uint32_t>(std::stoul(argv[2])) : 512;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("completions: %llu, in flight: %u\n", static_cast<unsigned long long>(completions), in_flight);
+    std::printf("%-28s %16s\n", "reaping path", "completions/s");
+    std::printf("%-28s %16.0f\n", "per-CQE cqe_seen (old)", run_per_cqe_seen(completions, in_flight));
+
+    for (std::uint32_t budget : {32u, 256u, 1024u, 4096u})
+    {
+        const std::string label = "batched, budget " + std::to_string(budget);
+        std::printf("%-28s %16.0f\n", label.c_str(), run_event_loop(completions, in_flight, budget));
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// spawn/complete throughput with pooled vs heap-allocated coroutine frames.
+//
+// Usage: ./frame_pool_bench [spawns]
+//
+// Each cycle is spawn(task) as the server does per packet: one spawn_task frame plus
+// one task frame, allocated, run to completion synchronously and freed. Runs once
+// with FrameAllocator pooling and once with global operator new, then reports the
+// live-frame counter, which must be back to zero.
+
+#include "io/include/logger.h"
+#include "coroutine/include/frame_allocator.h"
+#include "coroutine/include/task.h"
+#include "coroutine/include/spawn.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace co_uring;
+
+namespace
+{
+
+    std::uint64_t sink = 0;
+
+    task<void> small(std::uint64_t x)
+    {
+        sink += x;
+        co_return;
+    }
+
+    // Frame with a larger body, closer to SendData holding a buffer and an awaiter
+    task<void> larger(std::uint64_t x)
+    {
+        std::uint64_t scratch[48];
+        for (std::size_t i = 0; i < 48; ++i)
+        {
+            scratch[i] = x + i;
+        }
+        co_await small(scratch[x % 48]);
+    }
+
+    template <typename Factory>
+    void run(const char *label, bool pooling, std::size_t spawns, Factory factory)
+    {
+        auto &allocator = FrameAllocator::getInstance();
+        allocator.setPooling(pooling);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < spawns; ++i)
+        {
+            spawn(factory(i));
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%-16s %-5s %12.2f %10.1f %8lld\n", label, pooling ? "pool" : "heap",
+                    static_cast<double>(spawns) / seconds / 1e6, seconds * 1e9 / static_cast<double>(spawns),
+                    static_cast<long long>(allocator.stats().live));
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t spawns = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("%zu spawn/complete cycles per case\n", spawns);
+    std::printf("%-16s %-5s %12s %10s %8s\n", "case", "alloc", "M spawns/s", "ns/spawn", "live");
+
+    auto make_small = [](std::size_t i) { return small(i); };
+    auto make_larger = [](std::size_t i) { return larger(i); };
+    run("small frame", true, spawns, make_small);
+    run("small frame", false, spawns, make_small);
+    run("nested frames", true, spawns, make_larger);
+    run("nested frames", false, spawns, make_larger);
+
+    const auto stats = FrameAllocator::getInstance().stats();
+    std::printf("pooled %llu, heap %llu, peak live %lld, reserved %zu KiB (checksum %llu)\n",
+                static_cast<unsigned long long>(stats.pooled), static_cast<unsigned long long>(stats.heap),
+                static_cast<long long>(stats.peak_live), stats.reserved_bytes >> 10,
+                static_cast<unsigned long long>(sink));
+    return 0;
+}
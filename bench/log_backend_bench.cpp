@@ -0,0 +1,107 @@
+// Cost of an enabled LOG_INFO with the async backend, text against binary format.
+//
+// Usage: ./log_backend_bench [messages_per_thread] [max_threads] [dir]
+//
+// Each thread logs a typical session line (two integers and a string). "call" is the
+// producer-side cost per LOG_INFO, which is what a worker pays; "drain" is the time
+// until stop() has written everything, i.e. what the writer thread sustains. The ring
+// blocks when full, so nothing is dropped and both formats write every record.
+
+#include "io/include/log_backend.h"
+#include "io/include/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    struct result
+    {
+        double call_ns = 0;
+        double drain_seconds = 0;
+        LogBackendStats stats;
+    };
+
+    result run(LogFormat format, std::size_t threads, std::size_t messages, const std::string &path)
+    {
+        std::filesystem::remove(path);
+        LogBackendOptions options;
+        options.path = path;
+        options.format = format;
+        options.console = false;
+        options.overflow = LogOverflow::BLOCK;
+        options.rotate_bytes = 0;
+        if (!LogBackend::getInstance().start(options))
+        {
+            std::fprintf(stderr, "cannot start log backend on %s\n", path.c_str());
+            return {};
+        }
+
+        const std::string peer = "127.0.0.1:54321";
+        std::vector<double> per_thread(threads);
+        std::vector<std::thread> workers;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]
+                                 {
+                const auto begin = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < messages; ++i)
+                {
+                    LOG_INFO("📨 session {} received {} bytes from {}", t, i, peer);
+                }
+                per_thread[t] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count(); });
+        }
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+        LogBackend::getInstance().stop();
+
+        result r;
+        r.drain_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (double ns : per_thread)
+        {
+            r.call_ns += ns / static_cast<double>(messages) / static_cast<double>(threads);
+        }
+        r.stats = LogBackend::getInstance().getStats();
+        return r;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t messages = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+    const std::size_t max_threads = argc > 2 ? std::stoul(argv[2])
+                                             : std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1);
+    const std::string dir = argc > 3 ? argv[3] : "/tmp";
+
+    Logger::getInstance().setLogLevel(LogLevel::INFO);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("%8s %8s %12s %14s %12s\n", "format", "threads", "call ns", "drain Mmsg/s", "file MiB");
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (LogFormat format : {LogFormat::TEXT, LogFormat::BINARY})
+        {
+            const bool binary = format == LogFormat::BINARY;
+            const std::string path = dir + (binary ? "/log_backend_bench.blog" : "/log_backend_bench.log");
+            const std::uint64_t bytes_before = LogBackend::getInstance().getStats().bytes;
+            const result r = run(format, threads, messages, path);
+            const double total = static_cast<double>(messages * threads);
+            std::printf("%8s %8zu %12.1f %14.2f %12.1f\n", binary ? "binary" : "text", threads, r.call_ns,
+                        total / r.drain_seconds / 1e6,
+                        static_cast<double>(r.stats.bytes - bytes_before) / (1024.0 * 1024.0));
+            std::filesystem::remove(path);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Cost of a log call that does not log.
+//
+// Usage: ./log_disabled_bench [iterations]
+//
+//  - compiled out: a call below CO_URING_LOG_MIN_LEVEL; the loop body is empty.
+//  - runtime filtered: LOG_DEBUG with the level at WARN. One relaxed load and a
+//    compare; the arguments (including a std::string) are never evaluated.
+//  - eager filter: what the macros did before, building std::string file/func/format
+//    arguments and only then comparing the level inside the logger.
+//  - enabled: LOG_WARN with console and file output off, i.e. formatting alone, for scale.
+
+#include "io/include/logger.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace co_uring;
+
+namespace
+{
+
+    template <typename T>
+    inline void keep(T &value)
+    {
+        asm volatile("" : "+r"(value) : : "memory");
+    }
+
+    // The pre-filter call shape: every argument is materialised before the check
+    [[gnu::noinline]] void eager_log(LogLevel level, const std::string &file, int line, const std::string &func,
+                                     const std::string &format, const std::string &arg)
+    {
+        if (!Logger::isEnabled(level))
+        {
+            return;
+        }
+        Logger::getInstance().logMessage(level, "", line, "", file + ":" + func + " " + format + arg);
+    }
+
+    template <typename Body>
+    double measure(std::size_t iterations, Body body)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            body(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100'000'000;
+
+    auto &logger = Logger::getInstance();
+    logger.setLogLevel(LogLevel::WARN);
+    logger.setConsoleOutput(false);
+
+    const std::string peer = "127.0.0.1:54321";
+    std::uint64_t sink = 0;
+
+    const double compiled_out = measure(iterations, [&](std::size_t i)
+                                        {
+        // Same expansion as LOG_* with a level below any CO_URING_LOG_MIN_LEVEL
+        CO_URING_LOG(-1, LogLevel::DEBUG, "📨 {} bytes from {}", i, peer);
+        keep(sink); });
+
+    const double runtime_filtered = measure(iterations, [&](std::size_t i)
+                                            {
+        LOG_DEBUG("📨 {} bytes from {}", i, peer);
+        keep(sink); });
+
+    const double eager = measure(iterations / 10, [&](std::size_t)
+                                 {
+        eager_log(LogLevel::DEBUG, __FILE__, __LINE__, __FUNCTION__, "📨 bytes from {}", peer);
+        keep(sink); });
+
+    const double enabled = measure(iterations / 100, [&](std::size_t i)
+                                   {
+        LOG_WARN("📨 {} bytes from {}", i, peer);
+        keep(sink); });
+
+    std::printf("CO_URING_LOG_MIN_LEVEL %d, runtime level WARN\n", CO_URING_LOG_MIN_LEVEL);
+    std::printf("%-20s %10.2f ns/call\n", "compiled out", compiled_out);
+    std::printf("%-20s %10.2f ns/call\n", "runtime filtered", runtime_filtered);
+    std::printf("%-20s %10.2f ns/call\n", "eager filter", eager);
+    std::printf("%-20s %10.2f ns/call\n", "enabled (no output)", enabled);
+    return 0;
+}
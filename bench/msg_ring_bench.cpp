@@ -0,0 +1,121 @@
+// Cross-worker ping-pong latency through Mailbox (MPSC queue + IORING_OP_MSG_RING).
+//
+// Usage: ./msg_ring_bench [round_trips]
+//
+// Two worker threads each run their own ring. A coroutine on worker 0 hops to
+// worker 1 and back with switch_to_worker; every hop is one queue push and one
+// MSG_RING CQE on the target. Reports round-trip percentiles and throughput.
+
+#include "io/include/io_uring.h"
+#include "io/include/mailbox.h"
+#include "io/include/logger.h"
+#include "coroutine/include/task.h"
+#include "coroutine/include/spawn.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    std::atomic<std::size_t> attached_workers{0};
+
+    task<void> ping_pong(std::size_t round_trips, std::vector<std::uint32_t> &samples_ns,
+                         std::chrono::nanoseconds &total)
+    {
+        const std::size_t warmup = round_trips / 10;
+        auto begin = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < warmup + round_trips; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (i == warmup)
+            {
+                begin = start;
+            }
+            co_await switch_to_worker(1);
+            co_await switch_to_worker(0);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            if (i >= warmup)
+            {
+                samples_ns.push_back(static_cast<std::uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+        }
+
+        total = std::chrono::steady_clock::now() - begin;
+
+        Mailbox::post(1, []()
+                      { IoUring::getInstance().stop(); });
+        IoUring::getInstance().stop();
+    }
+
+    void run_worker(std::size_t index, std::size_t round_trips, std::vector<std::uint32_t> &samples_ns,
+                    std::chrono::nanoseconds &total)
+    {
+        auto &ring = IoUring::getInstance();
+        if (ring.queueInit() != 0)
+        {
+            std::fprintf(stderr, "worker %zu: queueInit failed\n", index);
+            return;
+        }
+        Mailbox::getInstance().attach(index);
+
+        attached_workers.fetch_add(1);
+        while (attached_workers.load() < 2)
+        {
+            std::this_thread::yield();
+        }
+
+        if (index == 0)
+        {
+            spawn(ping_pong(round_trips, samples_ns, total));
+        }
+        ring.eventLoop();
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t round_trips = argc > 1 ? std::stoul(argv[1]) : 200'000;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::vector<std::uint32_t> samples_ns;
+    samples_ns.reserve(round_trips);
+    std::chrono::nanoseconds total{0};
+
+    std::thread worker0(run_worker, 0, round_trips, std::ref(samples_ns), std::ref(total));
+    std::thread worker1(run_worker, 1, round_trips, std::ref(samples_ns), std::ref(total));
+    worker0.join();
+    worker1.join();
+
+    if (samples_ns.empty())
+    {
+        std::fprintf(stderr, "no samples\n");
+        return 1;
+    }
+
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto at = [&](double p)
+    {
+        return samples_ns[static_cast<std::size_t>(p * static_cast<double>(samples_ns.size() - 1))] / 1000.0;
+    };
+
+    std::printf("round trips: %zu (2 MSG_RING hops each), latency in us\n", samples_ns.size());
+    std::printf("%9s %9s %9s %9s %9s\n", "p50", "p90", "p99", "p99.9", "max");
+    std::printf("%9.2f %9.2f %9.2f %9.2f %9.2f\n", at(0.50), at(0.90), at(0.99), at(0.999),
+                samples_ns.back() / 1000.0);
+    std::printf("throughput: %.0f round trips/s\n",
+                static_cast<double>(samples_ns.size()) * 1e9 / static_cast<double>(total.count()));
+    return 0;
+}
@@ -0,0 +1,173 @@
+// offload() round-trip latency and throughput scaling with compute pool size.
+//
+// Usage: ./offload_bench [round_trips] [jobs] [job_us]
+//
+// One worker thread runs a ring with an attached Mailbox, as GameServer workers do.
+//  - latency: one coroutine offloads an empty function round_trips times; each
+//    round trip is injection + pool wakeup + MSG_RING wakeback to the worker.
+//  - scaling: 64 coroutines on the worker offload jobs of ~job_us CPU each until
+//    `jobs` have run, for pool sizes 1, 2, 4, ... up to the core count.
+
+#include "io/include/io_uring.h"
+#include "io/include/mailbox.h"
+#include "io/include/compute_pool.h"
+#include "io/include/logger.h"
+#include "coroutine/include/task.h"
+#include "coroutine/include/spawn.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    constexpr std::size_t CONCURRENT_COROUTINES = 64;
+
+    std::uint64_t burn(std::chrono::microseconds duration)
+    {
+        std::uint64_t x = 0x9E3779B97F4A7C15ULL;
+        const auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until)
+        {
+            for (int i = 0; i < 64; ++i)
+            {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+            }
+        }
+        return x;
+    }
+
+    task<void> latency_loop(std::size_t round_trips, std::vector<std::uint32_t> &samples_ns)
+    {
+        const std::size_t warmup = round_trips / 10;
+        for (std::size_t i = 0; i < warmup + round_trips; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            co_await offload([] { return 0; });
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            if (i >= warmup)
+            {
+                samples_ns.push_back(static_cast<std::uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+        }
+        IoUring::getInstance().stop();
+    }
+
+    struct scaling_state
+    {
+        std::size_t remaining_jobs = 0;
+        std::size_t running = 0;
+        std::uint64_t checksum = 0;
+    };
+
+    task<void> scaling_loop(scaling_state &state, std::chrono::microseconds job)
+    {
+        // Everything below runs on the worker thread, so the counters need no atomics
+        while (state.remaining_jobs > 0)
+        {
+            --state.remaining_jobs;
+            state.checksum += co_await offload([job] { return burn(job); });
+        }
+        if (--state.running == 0)
+        {
+            IoUring::getInstance().stop();
+        }
+    }
+
+    template <typename Body>
+    void on_worker(Body body)
+    {
+        std::thread worker([&body]
+                           {
+            auto &ring = IoUring::getInstance();
+            if (ring.queueInit() != 0)
+            {
+                std::fprintf(stderr, "queueInit failed\n");
+                return;
+            }
+            Mailbox::getInstance().attach(0);
+            body();
+            ring.eventLoop();
+            Mailbox::getInstance().detach(); });
+        worker.join();
+    }
+
+    void run_latency(std::size_t round_trips)
+    {
+        std::vector<std::uint32_t> samples_ns;
+        samples_ns.reserve(round_trips);
+        ComputePool::getInstance().start(1);
+        on_worker([&] { spawn(latency_loop(round_trips, samples_ns)); });
+        ComputePool::getInstance().stop();
+
+        if (samples_ns.empty())
+        {
+            return;
+        }
+        std::sort(samples_ns.begin(), samples_ns.end());
+        auto at = [&](double p)
+        {
+            return samples_ns[static_cast<std::size_t>(p * static_cast<double>(samples_ns.size() - 1))] / 1000.0;
+        };
+        std::printf("offload round trip (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", at(0.50),
+                    at(0.90), at(0.99), at(0.999), samples_ns.back() / 1000.0);
+    }
+
+    double run_scaling(std::size_t threads, std::size_t jobs, std::chrono::microseconds job)
+    {
+        scaling_state state;
+        state.remaining_jobs = jobs;
+        state.running = CONCURRENT_COROUTINES;
+
+        ComputePool::getInstance().start(threads);
+        const auto start = std::chrono::steady_clock::now();
+        on_worker([&]
+                  {
+            for (std::size_t i = 0; i < CONCURRENT_COROUTINES; ++i)
+            {
+                spawn(scaling_loop(state, job));
+            } });
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto stats = ComputePool::getInstance().getStats();
+        ComputePool::getInstance().stop();
+
+        const double rate = static_cast<double>(jobs) / seconds;
+        std::printf("%8zu %12.0f %10llu %10llu\n", threads, rate, static_cast<unsigned long long>(stats.executed),
+                    static_cast<unsigned long long>(stats.stolen));
+        return rate;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t round_trips = argc > 1 ? std::stoul(argv[1]) : 100'000;
+    const std::size_t jobs = argc > 2 ? std::stoul(argv[2]) : 200'000;
+    const std::chrono::microseconds job_us{argc > 3 ? std::stol(argv[3]) : 20};
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    run_latency(round_trips);
+
+    std::printf("\n%zu jobs of ~%lld us from %zu coroutines on one worker\n", jobs,
+                static_cast<long long>(job_us.count()), CONCURRENT_COROUTINES);
+    std::printf("%8s %12s %10s %10s\n", "threads", "jobs/s", "executed", "stolen");
+
+    // One core stays with the I/O worker
+    const std::size_t cores = std::max<std::size_t>(std::thread::hardware_concurrency(), 2);
+    for (std::size_t threads = 1; threads < cores; threads *= 2)
+    {
+        run_scaling(threads, jobs, job_us);
+    }
+    return 0;
+}
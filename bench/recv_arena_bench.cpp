@@ -0,0 +1,139 @@
+// Recv throughput and dTLB misses with the BufferRing arena on huge pages vs 4K pages.
+//
+// Usage: ./recv_arena_bench [megabytes] [chunk_bytes]
+//
+// A worker thread runs a multishot recv over a socketpair and reads every byte of
+// every received buffer; the main thread streams data into it. dTLB load misses are
+// counted on the worker thread with perf_event_open (needs perf_event_paranoid <= 2).
+// Huge pages need either reserved pages (vm.nr_hugepages) or THP in madvise/always mode.
+
+#include "recv_harness.h"
+#include "io/include/logger.h"
+#include "coroutine/include/spawn.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace co_uring;
+
+namespace
+{
+
+    struct result
+    {
+        recv_harness::drain_result drained;
+        std::int64_t dtlb_misses = -1;
+        ArenaBacking backing = ArenaBacking::NONE;
+    };
+
+    int open_dtlb_counter()
+    {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    task<void> drain_then_stop(socket_client &client, recv_harness::drain_result &out)
+    {
+        co_await recv_harness::drain(client, out);
+        IoUring::getInstance().stop();
+    }
+
+    void run_worker(int fd, bool hugepages, result &out)
+    {
+        BufferRingOptions options;
+        options.hugepages = hugepages;
+        int counter = -1;
+        recv_harness::run_worker(fd, {}, options, [&](socket_client &client)
+                                 {
+            out.backing = BufferRing::getInstance().arenaBacking();
+            // Counted from here: only the receive loop, not arena setup and prefaulting
+            counter = open_dtlb_counter();
+            if (counter >= 0)
+            {
+                ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+                ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+            }
+            spawn(drain_then_stop(client, out.drained)); });
+
+        if (counter >= 0)
+        {
+            ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+            std::int64_t misses = 0;
+            if (read(counter, &misses, sizeof(misses)) == sizeof(misses))
+            {
+                out.dtlb_misses = misses;
+            }
+            close(counter);
+        }
+    }
+
+    const char *backing_name(ArenaBacking backing)
+    {
+        switch (backing)
+        {
+        case ArenaBacking::HUGETLB:
+            return "hugetlb";
+        case ArenaBacking::TRANSPARENT_HUGEPAGES:
+            return "thp";
+        case ArenaBacking::PAGES:
+            return "4k";
+        default:
+            return "none";
+        }
+    }
+
+    void run(const char *label, bool hugepages, std::size_t total_bytes, std::size_t chunk_bytes)
+    {
+        int fds[2];
+        if (!recv_harness::open_pair(fds))
+        {
+            return;
+        }
+
+        result out;
+        std::thread worker(run_worker, fds[1], hugepages, std::ref(out));
+
+        const auto payload = recv_harness::pattern(chunk_bytes);
+        const auto start = std::chrono::steady_clock::now();
+        recv_harness::stream(fds[0], payload, total_bytes);
+        close(fds[0]);
+        worker.join();
+
+        const double seconds = std::chrono::duration<double>(out.drained.finished - start).count();
+        const double mib = static_cast<double>(out.drained.bytes) / (1024.0 * 1024.0);
+        std::printf("%-10s %-8s %10.1f %14lld %14.2f\n", label, backing_name(out.backing),
+                    seconds > 0 ? mib / seconds : 0.0, static_cast<long long>(out.dtlb_misses),
+                    out.dtlb_misses >= 0 && mib > 0 ? static_cast<double>(out.dtlb_misses) / mib : -1.0);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 2048;
+    const std::size_t chunk_bytes = argc > 2 ? std::stoul(argv[2]) : 64 * 1024;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("streaming %zu MiB in %zu-byte writes; dTLB misses are user-space loads on the worker\n",
+                megabytes, chunk_bytes);
+    std::printf("%-10s %-8s %10s %14s %14s\n", "arena", "backing", "MiB/s", "dTLB misses", "misses/MiB");
+
+    run("hugepages", true, megabytes * 1024 * 1024, chunk_bytes);
+    run("pages", false, megabytes * 1024 * 1024, chunk_bytes);
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Bulk-receive cost with and without recv bundles.
+//
+// Usage: ./recv_bundle_bench [megabytes] [write_bytes]
+//
+// A worker thread runs a multishot recv over a socketpair while the main thread
+// writes large bursts into it. Without bundles every provided buffer costs one CQE
+// and one consumer resume; with IORING_RECVSEND_BUNDLE (6.10+) a CQE hands over a
+// run of buffers. Reports consumer resumes and CQEs per MiB and throughput.
+// Incremental consumption is turned off for both runs since it takes precedence.
+
+#include "recv_harness.h"
+#include "io/include/logger.h"
+#include "coroutine/include/spawn.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace co_uring;
+
+namespace
+{
+
+    struct result
+    {
+        recv_harness::drain_result drained;
+        std::uint64_t completions = 0;
+        bool bundles = false;
+    };
+
+    task<void> drain_then_stop(socket_client &client, recv_harness::drain_result &out)
+    {
+        co_await recv_harness::drain(client, out);
+        IoUring::getInstance().stop();
+    }
+
+    void run_worker(int fd, bool bundles, result &out)
+    {
+        BufferRingOptions options;
+        options.incremental = false;
+        options.bundles = bundles;
+        auto &ring = IoUring::getInstance();
+        std::uint64_t completions_before = 0;
+        const bool ran = recv_harness::run_worker(fd, {}, options, [&](socket_client &client)
+                                                  {
+            out.bundles = BufferRing::getInstance().bundlesEnabled();
+            completions_before = ring.getStats().completions;
+            spawn(drain_then_stop(client, out.drained)); });
+        if (ran)
+        {
+            out.completions = ring.getStats().completions - completions_before;
+        }
+    }
+
+    void run(const char *label, bool bundles, std::size_t total_bytes, std::size_t write_bytes)
+    {
+        int fds[2];
+        if (!recv_harness::open_pair(fds))
+        {
+            return;
+        }
+
+        // Let a burst queue up behind the recv so there is something to bundle
+        const int sndbuf = static_cast<int>(std::max<std::size_t>(write_bytes * 2, 1 << 20));
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &sndbuf, sizeof(sndbuf));
+
+        result out;
+        std::thread worker(run_worker, fds[1], bundles, std::ref(out));
+
+        const auto payload = recv_harness::pattern(write_bytes);
+        const auto start = std::chrono::steady_clock::now();
+        recv_harness::stream(fds[0], payload, total_bytes);
+        close(fds[0]);
+        worker.join();
+
+        const auto &drained = out.drained;
+        const double seconds = std::chrono::duration<double>(drained.finished - start).count();
+        const double mib = static_cast<double>(drained.bytes) / (1024.0 * 1024.0);
+        auto per_mib = [&](std::uint64_t n) { return mib > 0 ? static_cast<double>(n) / mib : 0.0; };
+        std::printf("%-10s %-4s %10.1f %12.1f %12.1f %12.2f\n", label, out.bundles ? "yes" : "no",
+                    seconds > 0 ? mib / seconds : 0.0, per_mib(drained.chunks), per_mib(out.completions),
+                    drained.chunks > 0 ? static_cast<double>(drained.buffers) / static_cast<double>(drained.chunks)
+                                       : 0.0);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 1024;
+    const std::size_t write_bytes = argc > 2 ? std::stoul(argv[2]) : 256 * 1024;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("streaming %zu MiB in %zu-byte writes (4 KiB buffers, no incremental consumption)\n", megabytes,
+                write_bytes);
+    std::printf("%-10s %-4s %10s %12s %12s %12s\n", "mode", "on", "MiB/s", "resumes/MiB", "CQEs/MiB",
+                "bufs/resume");
+
+    run("bundles", true, megabytes * 1024 * 1024, write_bytes);
+    run("single", false, megabytes * 1024 * 1024, write_bytes);
+    return 0;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+// Shared plumbing of the receive-path benches: a worker thread runs the real
+// IoUring/BufferRing/socket_client stack on one end of a socketpair, the bench
+// thread drives the other end with blocking calls. Each bench keeps only what it
+// varies (ring or buffer options, extra coroutines, counters).
+
+#include "io/include/io_uring.h"
+#include "io/include/buffer_ring.h"
+#include "io/include/socket.h"
+#include "coroutine/include/task.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace recv_harness
+{
+
+    using namespace co_uring;
+
+    // Totals of drain(); finished is when the peer's EOF arrived
+    struct drain_result
+    {
+        std::uint64_t bytes = 0;
+        std::uint64_t checksum = 0;
+        std::uint64_t chunks = 0;
+        std::uint64_t buffers = 0;
+        std::chrono::steady_clock::time_point finished;
+    };
+
+    // Reads every byte of every chunk until EOF, so the buffers are actually touched
+    inline task<void> drain(socket_client &client, drain_result &out)
+    {
+        auto &buffer_ring = BufferRing::getInstance();
+        auto stream = client.recv_multishot();
+
+        while (true)
+        {
+            auto chunk = co_await stream.next();
+            if (chunk.result <= 0)
+            {
+                break;
+            }
+
+            std::uint64_t sum = 0;
+            buffer_ring.forEachSlice(chunk.buffer_id, chunk.offset, chunk.length, chunk.buffer_count,
+                                     [&](std::span<std::uint8_t> buffer)
+                                     {
+                                         for (auto byte : buffer)
+                                         {
+                                             sum += byte;
+                                         }
+                                     });
+            out.checksum += sum;
+            out.bytes += chunk.length;
+            ++out.chunks;
+            out.buffers += chunk.buffer_count;
+            buffer_ring.returnBufs(chunk.buffer_id, chunk.buffer_count);
+        }
+
+        out.finished = std::chrono::steady_clock::now();
+    }
+
+    // Sends back everything received until EOF
+    inline task<void> echo(socket_client &client)
+    {
+        auto &buffer_ring = BufferRing::getInstance();
+        auto stream = client.recv_multishot();
+        std::vector<std::span<std::uint8_t>> slices;
+
+        while (true)
+        {
+            auto chunk = co_await stream.next();
+            if (chunk.result <= 0)
+            {
+                break;
+            }
+
+            // A bundle spans several buffers; collect them first since the callback cannot co_await
+            slices.clear();
+            buffer_ring.forEachSlice(chunk.buffer_id, chunk.offset, chunk.length, chunk.buffer_count,
+                                     [&](std::span<std::uint8_t> buffer) { slices.push_back(buffer); });
+            for (auto buffer : slices)
+            {
+                co_await client.send(std::span<const std::uint8_t>(buffer.data(), buffer.size()));
+            }
+            buffer_ring.returnBufs(chunk.buffer_id, chunk.buffer_count);
+        }
+    }
+
+    // Worker thread body: set up this thread's ring and buffer ring, let start(client) spawn
+    // the coroutines, then run the loop until one of them stops it. On setup failure the
+    // worker's end is closed so the bench thread does not block on it; returns false.
+    template <typename Start>
+    bool run_worker(int fd, const IoUringOptions &ring_options, const BufferRingOptions &buffer_options,
+                    Start &&start)
+    {
+        auto &ring = IoUring::getInstance();
+        if (ring.queueInit(ring_options) != 0 || BufferRing::getInstance().registerBufRing(buffer_options) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        socket_client client{static_cast<std::uint32_t>(fd)};
+        std::forward<Start>(start)(client);
+        ring.eventLoop();
+        return true;
+    }
+
+    // fds[0] is the bench thread's end, fds[1] the worker's
+    inline bool open_pair(int (&fds)[2])
+    {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+        {
+            std::perror("socketpair");
+            return false;
+        }
+        return true;
+    }
+
+    // Bytes 0, 1, 2, ... so checksums differ between offsets
+    inline std::vector<std::uint8_t> pattern(std::size_t bytes)
+    {
+        std::vector<std::uint8_t> payload(bytes);
+        for (std::size_t i = 0; i < payload.size(); ++i)
+        {
+            payload[i] = static_cast<std::uint8_t>(i);
+        }
+        return payload;
+    }
+
+    // Blocking writes of payload until total_bytes are out; returns the bytes sent
+    inline std::size_t stream(int fd, std::span<const std::uint8_t> payload, std::size_t total_bytes)
+    {
+        std::size_t sent = 0;
+        while (sent < total_bytes)
+        {
+            const ssize_t n = send(fd, payload.data(), std::min(payload.size(), total_bytes - sent), 0);
+            if (n <= 0)
+            {
+                std::perror("send");
+                break;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+        return sent;
+    }
+
+    // One blocking echo round trip in nanoseconds, -1 if the echo failed
+    inline std::int64_t round_trip(int fd, std::span<const std::uint8_t> payload, std::span<std::uint8_t> reply)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (send(fd, payload.data(), payload.size(), 0) != static_cast<ssize_t>(payload.size()) ||
+            recv(fd, reply.data(), reply.size(), MSG_WAITALL) != static_cast<ssize_t>(reply.size()))
+        {
+            return -1;
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+            .count();
+    }
+
+    // p-th quantile of sorted nanosecond samples, in microseconds
+    inline double quantile_us(const std::vector<std::uint32_t> &sorted_ns, double p)
+    {
+        return sorted_ns[static_cast<std::size_t>(p * static_cast<double>(sorted_ns.size() - 1))] / 1000.0;
+    }
+
+} // namespace recv_harness
@@ -0,0 +1,149 @@
+// Echo tail latency next to one CPU-bound coroutine on the same worker.
+//
+// Usage: ./sched_fairness_bench [seconds_per_case] [payload_bytes]
+//
+// A worker thread runs an echo session over a socketpair and a "pathological
+// session" that burns CPU without touching I/O, handing the thread back with
+// co_await yield() after every slice. The main thread measures echo round trips
+// while the hog runs. Long slices approximate a handler that never yields: the
+// echo waits for the whole slice. Short slices let the ready-queue budget
+// interleave the echo's CQEs with the hog.
+
+#include "recv_harness.h"
+#include "io/include/scheduler.h"
+#include "io/include/logger.h"
+#include "coroutine/include/spawn.h"
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    struct shared_state
+    {
+        std::atomic<bool> stop{false};
+        // Coroutines still running on the worker; the last one out stops the loop
+        int running = 0;
+        std::uint64_t hog_slices = 0;
+    };
+
+    void finish(shared_state &state)
+    {
+        if (--state.running == 0)
+        {
+            IoUring::getInstance().stop();
+        }
+    }
+
+    task<void> echo(socket_client &client, shared_state &state)
+    {
+        co_await recv_harness::echo(client);
+        finish(state);
+    }
+
+    task<void> hog(std::chrono::microseconds slice, shared_state &state)
+    {
+        // Start from the event loop, not from spawn() before the loop runs
+        co_await yield();
+
+        volatile std::uint64_t sink = 0;
+        while (!state.stop.load(std::memory_order_relaxed))
+        {
+            const auto until = std::chrono::steady_clock::now() + slice;
+            while (std::chrono::steady_clock::now() < until)
+            {
+                sink = sink + 1;
+            }
+            ++state.hog_slices;
+            co_await yield();
+        }
+
+        finish(state);
+    }
+
+    void run_worker(int fd, std::chrono::microseconds slice, shared_state &state)
+    {
+        recv_harness::run_worker(fd, {}, {}, [&](socket_client &client)
+                                 {
+            state.running = slice.count() > 0 ? 2 : 1;
+            spawn(echo(client, state));
+            if (slice.count() > 0)
+            {
+                spawn(hog(slice, state));
+            } });
+    }
+
+    void run(const char *label, std::chrono::microseconds slice, double seconds, std::size_t payload_bytes)
+    {
+        int fds[2];
+        if (!recv_harness::open_pair(fds))
+        {
+            return;
+        }
+
+        shared_state state;
+        std::thread worker(run_worker, fds[1], slice, std::ref(state));
+
+        std::vector<std::uint8_t> payload(payload_bytes, 0x42);
+        std::vector<std::uint8_t> reply(payload_bytes);
+        std::vector<std::uint32_t> samples_ns;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            const std::int64_t ns = recv_harness::round_trip(fds[0], payload, reply);
+            if (ns < 0)
+            {
+                std::fprintf(stderr, "%s: echo failed\n", label);
+                break;
+            }
+            samples_ns.push_back(static_cast<std::uint32_t>(ns));
+        }
+
+        // The hog sees stop on its next slice, the echo sees EOF
+        state.stop = true;
+        close(fds[0]);
+        worker.join();
+
+        if (samples_ns.empty())
+        {
+            return;
+        }
+        std::sort(samples_ns.begin(), samples_ns.end());
+        auto at = [&](double p) { return recv_harness::quantile_us(samples_ns, p); };
+        std::printf("%-12s %10zu %9.1f %9.1f %9.1f %9.1f %10llu\n", label, samples_ns.size(), at(0.50), at(0.99),
+                    at(0.999), samples_ns.back() / 1000.0, static_cast<unsigned long long>(state.hog_slices));
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const double seconds = argc > 1 ? std::stod(argv[1]) : 2.0;
+    const std::size_t payload_bytes = argc > 2 ? std::stoul(argv[2]) : 64;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("%.1f s per case, %zu-byte echo, latency in us, ready budget %u\n", seconds, payload_bytes,
+                Scheduler::DEFAULT_BUDGET);
+    std::printf("%-12s %10s %9s %9s %9s %9s %10s\n", "hog slice", "samples", "p50", "p99", "p99.9", "max",
+                "slices");
+
+    using std::chrono::microseconds;
+    run("no hog", microseconds{0}, seconds, payload_bytes);
+    run("10 ms", microseconds{10'000}, seconds, payload_bytes);
+    run("1 ms", microseconds{1'000}, seconds, payload_bytes);
+    run("100 us", microseconds{100}, seconds, payload_bytes);
+    run("10 us", microseconds{10}, seconds, payload_bytes);
+    return 0;
+}
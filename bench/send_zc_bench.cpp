@@ -0,0 +1,213 @@
+// Copy send vs. IORING_OP_SEND_ZC throughput on a loopback TCP connection.
+//
+// Usage: ./send_zc_bench [seconds_per_size]
+//
+// For each payload size the sender keeps one send in flight and the receiver
+// thread drains the socket. Zero-copy sends count as complete only after the
+// IORING_CQE_F_NOTIF CQE, which is what socket_client::send_awaiter waits for.
+// The first size where zero-copy is at least as fast as copying is the
+// crossover to use for ServerOptions::zc_send_threshold.
+
+#include <liburing.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+    struct connection
+    {
+        int sender = -1;
+        int receiver = -1;
+    };
+
+    connection connect_loopback()
+    {
+        connection conn;
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t addr_len = sizeof(addr);
+        if (::bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+            ::listen(listener, 1) < 0 ||
+            getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &addr_len) < 0)
+        {
+            close(listener);
+            return conn;
+        }
+
+        conn.sender = socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(conn.sender, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            close(conn.sender);
+            close(listener);
+            conn.sender = -1;
+            return conn;
+        }
+        conn.receiver = accept(listener, nullptr, nullptr);
+        close(listener);
+
+        int flag = 1;
+        setsockopt(conn.sender, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        return conn;
+    }
+
+    struct result
+    {
+        double gib_per_sec = 0.0;
+        std::uint64_t sends = 0;
+        std::uint64_t copied_notifs = 0;
+        bool failed = false;
+    };
+
+    result run(io_uring &ring, int fd, std::size_t size, bool zero_copy, std::chrono::milliseconds duration)
+    {
+        result res;
+        std::vector<std::uint8_t> payload(size, 0xA5);
+        std::uint64_t bytes = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + duration;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+            if (zero_copy)
+            {
+                io_uring_prep_send_zc(sqe, fd, payload.data(), payload.size(), 0, IORING_SEND_ZC_REPORT_USAGE);
+            }
+            else
+            {
+                io_uring_prep_send(sqe, fd, payload.data(), payload.size(), 0);
+            }
+            io_uring_submit(&ring);
+
+            // Copy send: one CQE. Zero-copy: result CQE with F_MORE, then the notification.
+            bool waiting = true;
+            while (waiting)
+            {
+                io_uring_cqe *cqe = nullptr;
+                if (io_uring_wait_cqe(&ring, &cqe) < 0)
+                {
+                    res.failed = true;
+                    return res;
+                }
+
+                if (cqe->flags & IORING_CQE_F_NOTIF)
+                {
+                    if (static_cast<std::uint32_t>(cqe->res) & IORING_NOTIF_USAGE_ZC_COPIED)
+                    {
+                        ++res.copied_notifs;
+                    }
+                    waiting = false;
+                }
+                else
+                {
+                    if (cqe->res < 0)
+                    {
+                        std::fprintf(stderr, "send failed: %s\n", std::strerror(-cqe->res));
+                        res.failed = true;
+                    }
+                    else
+                    {
+                        bytes += static_cast<std::uint64_t>(cqe->res);
+                    }
+                    waiting = (cqe->flags & IORING_CQE_F_MORE) != 0;
+                }
+                io_uring_cqe_seen(&ring, cqe);
+
+                if (res.failed)
+                {
+                    return res;
+                }
+            }
+            ++res.sends;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        res.gib_per_sec = static_cast<double>(bytes) / elapsed.count() / (1024.0 * 1024.0 * 1024.0);
+        return res;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const auto duration = std::chrono::milliseconds(argc > 1 ? std::stoi(argv[1]) * 1000 : 2000);
+
+    connection conn = connect_loopback();
+    if (conn.sender < 0 || conn.receiver < 0)
+    {
+        std::fprintf(stderr, "failed to set up loopback connection\n");
+        return 1;
+    }
+
+    io_uring ring;
+    if (int ret = io_uring_queue_init(64, &ring, 0); ret < 0)
+    {
+        std::fprintf(stderr, "io_uring_queue_init: %s\n", std::strerror(-ret));
+        return 1;
+    }
+
+    std::atomic<bool> draining{true};
+    std::thread drain([&]()
+                      {
+        std::vector<std::uint8_t> sink(1 << 20);
+        while (draining.load(std::memory_order_relaxed))
+        {
+            if (recv(conn.receiver, sink.data(), sink.size(), 0) <= 0)
+            {
+                break;
+            }
+        } });
+
+    std::printf("%10s %14s %14s %10s %14s\n", "size", "copy GiB/s", "zc GiB/s", "zc/copy", "zc copied");
+    std::size_t crossover = 0;
+    for (std::size_t size = 1024; size <= 256 * 1024; size *= 2)
+    {
+        result copy = run(ring, conn.sender, size, false, duration);
+        result zc = run(ring, conn.sender, size, true, duration);
+        if (copy.failed || zc.failed)
+        {
+            std::fprintf(stderr, "benchmark failed at size %zu\n", size);
+            break;
+        }
+
+        const double ratio = copy.gib_per_sec > 0.0 ? zc.gib_per_sec / copy.gib_per_sec : 0.0;
+        std::printf("%10zu %14.3f %14.3f %10.2f %8llu/%-8llu\n", size, copy.gib_per_sec, zc.gib_per_sec, ratio,
+                    static_cast<unsigned long long>(zc.copied_notifs), static_cast<unsigned long long>(zc.sends));
+        if (crossover == 0 && ratio >= 1.0)
+        {
+            crossover = size;
+        }
+    }
+
+    if (crossover != 0)
+    {
+        std::printf("crossover: zero-copy wins from %zu bytes\n", crossover);
+    }
+    else
+    {
+        std::printf("crossover: zero-copy never won in the measured range\n");
+    }
+
+    draining.store(false);
+    shutdown(conn.sender, SHUT_RDWR);
+    drain.join();
+    io_uring_queue_exit(&ring);
+    close(conn.sender);
+    close(conn.receiver);
+    return 0;
+}
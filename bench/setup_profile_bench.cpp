@@ -0,0 +1,112 @@
+// Echo round-trip tail latency for each io_uring setup profile.
+//
+// Usage: ./setup_profile_bench [round_trips] [payload_bytes]
+//
+// A worker thread runs the real IoUring/BufferRing/socket_client stack and
+// echoes over a socketpair; the main thread does blocking send/recv and records
+// the round-trip time of every message.
+
+#include "recv_harness.h"
+#include "io/include/logger.h"
+#include "coroutine/include/spawn.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    task<void> echo_then_stop(socket_client &client)
+    {
+        co_await recv_harness::echo(client);
+        IoUring::getInstance().stop();
+    }
+
+    void run_worker(int fd, IoUringOptions options)
+    {
+        recv_harness::run_worker(fd, options, {}, [](socket_client &client)
+                                 { spawn(echo_then_stop(client)); });
+    }
+
+    void report(const char *label, std::vector<std::uint32_t> &samples_ns)
+    {
+        std::sort(samples_ns.begin(), samples_ns.end());
+        auto at = [&](double p) { return recv_harness::quantile_us(samples_ns, p); };
+        std::printf("%-16s %9.1f %9.1f %9.1f %9.1f %9.1f\n", label, at(0.50), at(0.90), at(0.99), at(0.999),
+                    samples_ns.back() / 1000.0);
+    }
+
+    void run_profile(const char *label, IoUringOptions options, std::size_t round_trips, std::size_t payload_bytes)
+    {
+        int fds[2];
+        if (!recv_harness::open_pair(fds))
+        {
+            return;
+        }
+
+        std::thread worker(run_worker, fds[1], options);
+
+        std::vector<std::uint8_t> payload(payload_bytes, 0x42);
+        std::vector<std::uint8_t> reply(payload_bytes);
+        std::vector<std::uint32_t> samples_ns;
+        samples_ns.reserve(round_trips);
+
+        const std::size_t warmup = round_trips / 10;
+        for (std::size_t i = 0; i < warmup + round_trips; ++i)
+        {
+            const std::int64_t ns = recv_harness::round_trip(fds[0], payload, reply);
+            if (ns < 0)
+            {
+                std::fprintf(stderr, "%s: echo failed\n", label);
+                break;
+            }
+            if (i >= warmup)
+            {
+                samples_ns.push_back(static_cast<std::uint32_t>(ns));
+            }
+        }
+
+        // EOF ends the echo coroutine, which stops the worker's loop
+        close(fds[0]);
+        worker.join();
+
+        if (!samples_ns.empty())
+        {
+            report(label, samples_ns);
+        }
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t round_trips = argc > 1 ? std::stoul(argv[1]) : 200'000;
+    const std::size_t payload_bytes = argc > 2 ? std::stoul(argv[2]) : 64;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("round trips: %zu, payload: %zu bytes, latency in us\n", round_trips, payload_bytes);
+    std::printf("%-16s %9s %9s %9s %9s %9s\n", "profile", "p50", "p90", "p99", "p99.9", "max");
+
+    IoUringOptions options;
+    options.profile = SetupProfile::DEFAULT;
+    run_profile("default", options, round_trips, payload_bytes);
+
+    options.profile = SetupProfile::COOP_TASKRUN;
+    run_profile("coop_taskrun", options, round_trips, payload_bytes);
+
+    options.profile = SetupProfile::DEFER_TASKRUN;
+    run_profile("defer_taskrun", options, round_trips, payload_bytes);
+
+    options = {};
+    options.sqpoll = true;
+    run_profile("sqpoll", options, round_trips, payload_bytes);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Cost of awaiting a task<T> that completes synchronously.
+//
+// Usage: ./task_await_bench [awaits] [chain_depth]
+//
+// Everything runs on the main thread with no ring: a spawned coroutine awaits
+// child tasks in a loop (frame allocation + lazy start + symmetric transfer back +
+// frame destruction per await), then awaits a recursive chain chain_depth deep.
+// Symmetric transfer keeps both at constant stack depth; build with -O2 so the
+// compiler turns the transfers into tail calls.
+
+#include "io/include/logger.h"
+#include "coroutine/include/task.h"
+#include "coroutine/include/spawn.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace co_uring;
+
+namespace
+{
+
+    [[gnu::noinline]] std::uint64_t plain_call(std::uint64_t x)
+    {
+        return x + 1;
+    }
+
+    task<std::uint64_t> leaf(std::uint64_t x)
+    {
+        co_return x + 1;
+    }
+
+    task<void> leaf_void(std::uint64_t &x)
+    {
+        ++x;
+        co_return;
+    }
+
+    task<std::uint64_t> chain(std::size_t depth)
+    {
+        if (depth == 0)
+        {
+            co_return 0;
+        }
+        co_return co_await chain(depth - 1) + 1;
+    }
+
+    void report(const char *label, std::chrono::nanoseconds elapsed, std::size_t count, std::uint64_t check)
+    {
+        std::printf("%-22s %10.2f %14llu\n", label,
+                    static_cast<double>(elapsed.count()) / static_cast<double>(count),
+                    static_cast<unsigned long long>(check));
+    }
+
+    task<void> run(std::size_t awaits, std::size_t depth)
+    {
+        using clock = std::chrono::steady_clock;
+
+        auto start = clock::now();
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < awaits; ++i)
+        {
+            sum = plain_call(sum);
+        }
+        report("plain call", clock::now() - start, awaits, sum);
+
+        start = clock::now();
+        sum = 0;
+        for (std::size_t i = 0; i < awaits; ++i)
+        {
+            sum = co_await leaf(sum);
+        }
+        report("co_await task<T>", clock::now() - start, awaits, sum);
+
+        start = clock::now();
+        sum = 0;
+        for (std::size_t i = 0; i < awaits; ++i)
+        {
+            co_await leaf_void(sum);
+        }
+        report("co_await task<void>", clock::now() - start, awaits, sum);
+
+        start = clock::now();
+        sum = co_await chain(depth);
+        report("chain (per level)", clock::now() - start, depth, sum);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::size_t awaits = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+    const std::size_t depth = argc > 2 ? std::stoul(argv[2]) : 1'000'000;
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    Logger::getInstance().setConsoleOutput(false);
+
+    std::printf("%zu awaits, chain depth %zu\n", awaits, depth);
+    std::printf("%-22s %10s %14s\n", "case", "ns/op", "check");
+
+    // The coroutine runs to completion inside spawn(): nothing here suspends on I/O
+    spawn(run(awaits, depth));
+    return 0;
+}
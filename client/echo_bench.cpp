@@ -0,0 +1,173 @@
+#include <iostream>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+// 에코 경로 부하 측정 클라이언트
+// 사용법: ./echo_bench [host] [port] [connections] [payload_bytes] [seconds]
+//
+// 각 연결은 payload를 보내고 같은 크기의 에코를 받을 때까지 기다린 뒤 다음 요청을 보낸다.
+// 서버 옵션(--direct-fd, --sqpoll 등)을 바꿔가며 같은 인자로 실행해 전후를 비교한다.
+
+struct BenchResult
+{
+    std::uint64_t messages = 0;
+    std::vector<std::uint32_t> latencies_us;
+    bool failed = false;
+};
+
+static int connect_to(const std::string &host, int port)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+
+    int flag = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &server_addr.sin_addr) <= 0 ||
+        ::connect(sock, (sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static bool send_all(int sock, const std::uint8_t *data, std::size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t sent = send(sock, data, len, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        data += sent;
+        len -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+static void run_connection(const std::string &host, int port, std::size_t payload_bytes,
+                           const std::atomic<bool> &running, BenchResult &result)
+{
+    int sock = connect_to(host, port);
+    if (sock < 0)
+    {
+        result.failed = true;
+        return;
+    }
+
+    std::vector<std::uint8_t> payload(payload_bytes, 0x5A);
+    std::vector<std::uint8_t> echo(payload_bytes);
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (!send_all(sock, payload.data(), payload.size()))
+        {
+            result.failed = true;
+            break;
+        }
+
+        ssize_t received = recv(sock, echo.data(), echo.size(), MSG_WAITALL);
+        if (received != static_cast<ssize_t>(echo.size()))
+        {
+            result.failed = true;
+            break;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        result.latencies_us.push_back(static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        ++result.messages;
+    }
+
+    close(sock);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? std::stoi(argv[2]) : 8080;
+    std::size_t connections = argc > 3 ? std::stoul(argv[3]) : 64;
+    std::size_t payload_bytes = argc > 4 ? std::stoul(argv[4]) : 64;
+    int seconds = argc > 5 ? std::stoi(argv[5]) : 10;
+
+    std::cout << "🏁 에코 벤치마크 - " << host << ":" << port
+              << ", 연결: " << connections
+              << ", payload: " << payload_bytes << " bytes"
+              << ", 시간: " << seconds << "s" << std::endl;
+
+    std::atomic<bool> running{true};
+    std::vector<BenchResult> results(connections);
+    std::vector<std::thread> threads;
+    threads.reserve(connections);
+
+    for (std::size_t i = 0; i < connections; ++i)
+    {
+        threads.emplace_back(run_connection, host, port, payload_bytes, std::cref(running), std::ref(results[i]));
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running.store(false);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::uint64_t total_messages = 0;
+    std::size_t failed = 0;
+    std::vector<std::uint32_t> latencies;
+    for (auto &result : results)
+    {
+        total_messages += result.messages;
+        failed += result.failed ? 1 : 0;
+        latencies.insert(latencies.end(), result.latencies_us.begin(), result.latencies_us.end());
+    }
+
+    if (latencies.empty())
+    {
+        std::cerr << "❌ 측정된 메시지가 없습니다 (실패한 연결: " << failed << ")" << std::endl;
+        return 1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    {
+        return latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+    };
+
+    double msgs_per_sec = static_cast<double>(total_messages) / seconds;
+    double mb_per_sec = msgs_per_sec * static_cast<double>(payload_bytes) / (1024.0 * 1024.0);
+
+    std::cout << "📊 메시지: " << total_messages
+              << " (" << static_cast<std::uint64_t>(msgs_per_sec) << " msg/s, "
+              << mb_per_sec << " MB/s)" << std::endl;
+    std::cout << "⏱️ 지연(us) p50: " << percentile(0.50)
+              << ", p99: " << percentile(0.99)
+              << ", p99.9: " << percentile(0.999)
+              << ", max: " << latencies.back() << std::endl;
+    if (failed > 0)
+    {
+        std::cout << "⚠️ 실패한 연결: " << failed << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <utility>
+
+namespace co_uring
+{
+
+    // Cancellation slot for one suspended operation. An awaitable that can be cancelled
+    // binds itself here while it waits; request() then calls its cancel function, which
+    // must only arrange for the operation to complete early (an ASYNC_CANCEL SQE, a
+    // scheduled resume) and never resume anything inline.
+    struct cancel_scope
+    {
+        using cancel_fn = void (*)(void *target) noexcept;
+
+        // Cancels right away if the scope was cancelled before the operation started
+        void bind(cancel_fn fn, void *target) noexcept
+        {
+            fn_ = fn;
+            target_ = target;
+            if (requested_)
+            {
+                fire();
+            }
+        }
+
+        void unbind() noexcept
+        {
+            fn_ = nullptr;
+            target_ = nullptr;
+        }
+
+        void request() noexcept
+        {
+            if (requested_)
+            {
+                return;
+            }
+            requested_ = true;
+            fire();
+        }
+
+        [[nodiscard]] bool requested() const noexcept { return requested_; }
+
+    private:
+        void fire() noexcept
+        {
+            // One shot: the operation completes once, however often it is asked
+            if (fn_ != nullptr)
+            {
+                std::exchange(fn_, nullptr)(std::exchange(target_, nullptr));
+            }
+        }
+
+        cancel_fn fn_ = nullptr;
+        void *target_ = nullptr;
+        bool requested_ = false;
+    };
+
+    // Scope the awaiting coroutine runs under, nullptr for promises without one
+    // (spawn_task roots, foreign coroutine types)
+    template <typename Promise>
+    cancel_scope *cancel_scope_of(std::coroutine_handle<Promise> handle) noexcept
+    {
+        if constexpr (requires(Promise &p) {
+                          { p.cancel_scope_ } -> std::convertible_to<cancel_scope *>;
+                      })
+        {
+            return handle.promise().cancel_scope_;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+} // namespace co_uring
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace co_uring
+{
+
+    // Chase-Lev work-stealing deque of pointers (Lê, Pop, Cohen, Zappa Nardelli, PPoPP'13).
+    // The owner pushes and pops at the bottom; any thread steals from the top. The array
+    // grows on demand; retired arrays are kept until destruction because a thief may
+    // still be reading from one.
+    template <typename T>
+    class chase_lev_deque
+    {
+    public:
+        explicit chase_lev_deque(std::size_t capacity = 256)
+        {
+            std::size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            arrays_.push_back(std::make_unique<ring>(size));
+            array_.store(arrays_.back().get(), std::memory_order_relaxed);
+        }
+
+        chase_lev_deque(const chase_lev_deque &) = delete;
+        chase_lev_deque &operator=(const chase_lev_deque &) = delete;
+
+        // Owner only
+        void push(T *item)
+        {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t t = top_.load(std::memory_order_acquire);
+            ring *a = array_.load(std::memory_order_relaxed);
+            if (b - t > static_cast<std::int64_t>(a->mask))
+            {
+                a = grow(a, t, b);
+            }
+            a->put(b, item);
+            // Release store rather than the paper's fence + relaxed store: same cost on x86,
+            // and visible to ThreadSanitizer, which does not model fences
+            bottom_.store(b + 1, std::memory_order_release);
+        }
+
+        // Owner only; newest item first, nullptr if empty
+        T *pop()
+        {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            ring *a = array_.load(std::memory_order_relaxed);
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top_.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T *item = a->get(b);
+            if (t == b)
+            {
+                // Last item: race thieves for it
+                if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = nullptr;
+                }
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        // Any thread; oldest item first, nullptr if empty or lost a race
+        T *steal()
+        {
+            std::int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b = bottom_.load(std::memory_order_acquire);
+            if (t >= b)
+            {
+                return nullptr;
+            }
+
+            ring *a = array_.load(std::memory_order_acquire);
+            T *item = a->get(t);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return item;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct ring
+        {
+            explicit ring(std::size_t size) : mask(size - 1), slots(new std::atomic<T *>[size]) {}
+
+            T *get(std::int64_t i) const noexcept
+            {
+                return slots[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+            }
+            void put(std::int64_t i, T *item) noexcept
+            {
+                slots[static_cast<std::size_t>(i) & mask].store(item, std::memory_order_relaxed);
+            }
+
+            std::size_t mask;
+            std::unique_ptr<std::atomic<T *>[]> slots;
+        };
+
+        ring *grow(ring *old, std::int64_t t, std::int64_t b)
+        {
+            arrays_.push_back(std::make_unique<ring>((old->mask + 1) * 2));
+            ring *bigger = arrays_.back().get();
+            for (std::int64_t i = t; i < b; ++i)
+            {
+                bigger->put(i, old->get(i));
+            }
+            array_.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+
+        alignas(64) std::atomic<std::int64_t> top_{0};
+        alignas(64) std::atomic<std::int64_t> bottom_{0};
+        std::atomic<ring *> array_{nullptr};
+        // Owner only: every array ever used, for deferred reclamation
+        std::vector<std::unique_ptr<ring>> arrays_;
+    };
+
+} // namespace co_uring
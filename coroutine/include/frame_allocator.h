@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "../../io/include/logger.h"
+
+namespace co_uring
+{
+
+    struct FrameAllocatorStats
+    {
+        // Frames this thread allocated and nobody has freed yet, wherever they are freed
+        std::int64_t live = 0;
+        std::int64_t peak_live = 0;
+        std::uint64_t pooled = 0;
+        // Frames larger than the biggest class, served by global operator new
+        std::uint64_t heap = 0;
+        // Bytes carved into blocks so far; pooled memory is kept for the process lifetime
+        std::size_t reserved_bytes = 0;
+        // Blocks other threads handed back (a coroutine that moved with switch_to_worker)
+        std::uint64_t remote_frees = 0;
+    };
+
+    // Thread-local size-class free lists for coroutine frames. Frames are allocated on the
+    // event loop thread without locking. Each frame carries a small header naming the
+    // allocator and class it came from: a frame freed on its own thread goes straight back
+    // to the local list, one freed on another worker is pushed onto the owner's lock-free
+    // remote list, which the owner takes over before carving new blocks. Blocks therefore
+    // never migrate between workers. Blocks are never returned to the heap, and allocators
+    // live for the process, so a late free from any thread always has somewhere to go.
+    class FrameAllocator
+    {
+    public:
+        static constexpr std::array<std::size_t, 6> SIZE_CLASSES{64, 128, 256, 512, 1024, 2048};
+        // Blocks carved per refill of an empty class
+        static constexpr std::size_t BLOCKS_PER_REFILL = 64;
+
+        // Thread-local singleton access. Deliberately leaked: frames of an exited thread
+        // may still be freed by others.
+        static auto getInstance() noexcept -> FrameAllocator &
+        {
+            thread_local FrameAllocator *instance = new FrameAllocator();
+            return *instance;
+        }
+
+        FrameAllocator(const FrameAllocator &) = delete;
+        FrameAllocator &operator=(const FrameAllocator &) = delete;
+
+        void *allocate(std::size_t size)
+        {
+            const std::size_t total = size + sizeof(frame_header);
+            const std::size_t c = pooling_ ? classFor(total) : HEAP_CLASS;
+
+            void *raw;
+            if (c == HEAP_CLASS)
+            {
+                ++stats_.heap;
+                raw = ::operator new(total);
+            }
+            else
+            {
+                if (free_[c] == nullptr)
+                {
+                    refill(c);
+                }
+                free_block *block = free_[c];
+                free_[c] = block->next;
+                ++stats_.pooled;
+                raw = block;
+            }
+
+            bump_live();
+            auto *header = new (raw) frame_header{this, c};
+            return header + 1;
+        }
+
+        // Any thread may free any frame
+        static void deallocate(void *p) noexcept
+        {
+            auto *header = static_cast<frame_header *>(p) - 1;
+            FrameAllocator *owner = header->owner;
+            const std::size_t c = header->size_class;
+
+            if (owner != &getInstance())
+            {
+                owner->remote_frees_.fetch_add(1, std::memory_order_relaxed);
+                if (c == HEAP_CLASS)
+                {
+                    ::operator delete(header);
+                    return;
+                }
+                owner->pushRemote(c, reinterpret_cast<free_block *>(header));
+                return;
+            }
+
+            --owner->stats_.live;
+            if (c == HEAP_CLASS)
+            {
+                ::operator delete(header);
+                return;
+            }
+            auto *block = reinterpret_cast<free_block *>(header);
+            block->next = owner->free_[c];
+            owner->free_[c] = block;
+        }
+
+        // Switch between pooled and heap frames, e.g. for comparison. Safe at any time:
+        // every frame remembers how it was allocated.
+        void setPooling(bool enabled) noexcept { pooling_ = enabled; }
+
+        [[nodiscard]] FrameAllocatorStats stats() const noexcept
+        {
+            FrameAllocatorStats stats = stats_;
+            stats.remote_frees = static_cast<std::uint64_t>(remote_frees_.load(std::memory_order_relaxed));
+            stats.live -= remote_frees_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        void logStats() const
+        {
+            const FrameAllocatorStats s = stats();
+            LOG_INFO("🧩 coroutine frames: live {}, peak {}, pooled {}, heap {}, remote frees {}, reserved {} KiB", s.live,
+                     s.peak_live, s.pooled, s.heap, s.remote_frees, s.reserved_bytes >> 10);
+        }
+
+    private:
+        FrameAllocator() = default;
+
+        static constexpr std::size_t HEAP_CLASS = SIZE_CLASSES.size();
+
+        // In front of every frame; keeps the frame at the default new alignment
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) frame_header
+        {
+            FrameAllocator *owner;
+            // HEAP_CLASS for frames from global operator new
+            std::size_t size_class;
+        };
+
+        struct free_block
+        {
+            free_block *next;
+        };
+
+        // Index of the smallest class holding size, HEAP_CLASS if none does
+        static constexpr std::size_t classFor(std::size_t size) noexcept
+        {
+            if (size <= SIZE_CLASSES.front())
+            {
+                return 0;
+            }
+            if (size > SIZE_CLASSES.back())
+            {
+                return HEAP_CLASS;
+            }
+            return static_cast<std::size_t>(std::bit_width(size - 1)) - std::bit_width(SIZE_CLASSES.front() - 1);
+        }
+
+        void bump_live() noexcept
+        {
+            ++stats_.live;
+            const std::int64_t live = stats_.live - remote_frees_.load(std::memory_order_relaxed);
+            if (live > stats_.peak_live)
+            {
+                stats_.peak_live = live;
+            }
+        }
+
+        void pushRemote(std::size_t c, free_block *block) noexcept
+        {
+            free_block *head = remote_free_[c].load(std::memory_order_relaxed);
+            do
+            {
+                block->next = head;
+            } while (!remote_free_[c].compare_exchange_weak(head, block, std::memory_order_release,
+                                                            std::memory_order_relaxed));
+        }
+
+        void refill(std::size_t c)
+        {
+            // Blocks freed elsewhere first; new memory only when none came back
+            if (free_block *returned = remote_free_[c].exchange(nullptr, std::memory_order_acquire))
+            {
+                free_[c] = returned;
+                return;
+            }
+
+            const std::size_t block_size = SIZE_CLASSES[c];
+            auto *chunk = static_cast<std::byte *>(::operator new(block_size * BLOCKS_PER_REFILL));
+            stats_.reserved_bytes += block_size * BLOCKS_PER_REFILL;
+            for (std::size_t i = BLOCKS_PER_REFILL; i-- > 0;)
+            {
+                auto *block = reinterpret_cast<free_block *>(chunk + i * block_size);
+                block->next = free_[c];
+                free_[c] = block;
+            }
+        }
+
+        std::array<free_block *, SIZE_CLASSES.size()> free_{};
+        FrameAllocatorStats stats_;
+        bool pooling_ = true;
+
+        // Written by other threads; kept off the owner's hot cache line
+        alignas(64) std::array<std::atomic<free_block *>, SIZE_CLASSES.size()> remote_free_{};
+        std::atomic<std::int64_t> remote_frees_{0};
+    };
+
+    // Base for promise types: the compiler allocates the coroutine frame through these
+    struct pooled_frame
+    {
+        static void *operator new(std::size_t size)
+        {
+            return FrameAllocator::getInstance().allocate(size);
+        }
+
+        static void operator delete(void *p) noexcept
+        {
+            FrameAllocator::deallocate(p);
+        }
+    };
+
+} // namespace co_uring
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace co_uring
+{
+
+    // Unbounded lock-free multi-producer single-consumer queue (Vyukov node queue).
+    // push() is wait-free for producers; try_pop() must only be called by the consumer.
+    // A push can be briefly invisible to try_pop() until the producer links its node,
+    // so consumers re-check after every wakeup instead of relying on emptiness.
+    template <typename T>
+    class mpsc_queue
+    {
+    public:
+        mpsc_queue() noexcept : head_(&stub_), tail_(&stub_) {}
+
+        ~mpsc_queue()
+        {
+            T discarded;
+            while (try_pop(discarded))
+            {
+            }
+            if (tail_ != &stub_)
+            {
+                delete tail_;
+            }
+        }
+
+        mpsc_queue(const mpsc_queue &) = delete;
+        mpsc_queue &operator=(const mpsc_queue &) = delete;
+
+        void push(T value)
+        {
+            auto *item = new node{};
+            item->value = std::move(value);
+            node *prev = head_.exchange(item, std::memory_order_acq_rel);
+            prev->next.store(item, std::memory_order_release);
+        }
+
+        bool try_pop(T &out)
+        {
+            node *tail = tail_;
+            node *next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr)
+            {
+                return false;
+            }
+
+            // next becomes the new dummy once its value is moved out
+            out = std::move(next->value);
+            tail_ = next;
+            if (tail != &stub_)
+            {
+                delete tail;
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return tail_->next.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        struct node
+        {
+            std::atomic<node *> next{nullptr};
+            T value{};
+        };
+
+        node stub_;
+        alignas(64) std::atomic<node *> head_;
+        alignas(64) node *tail_;
+    };
+
+} // namespace co_uring
@@ -4,6 +4,7 @@
 #include <exception>
 #include <iostream>
 #include <utility>
+#include "frame_allocator.h"
 #include "../../io/include/logger.h"
 
 namespace co_uring
@@ -13,7 +14,8 @@ namespace co_uring
     class spawn_task
     {
     public:
-        struct promise_type
+        // 프레임은 워커별 풀에서 할당 (FrameAllocator)
+        struct promise_type : pooled_frame
         {
             spawn_task get_return_object()
             {
@@ -1,78 +1,128 @@
 #pragma once
 
 #include <coroutine>
+#include <cstddef>
 #include <exception>
+#include <optional>
+#include <stdexcept>
 #include <utility>
-#include <thread>
-#include <iostream>
+#include "cancel_scope.h"
+#include "frame_allocator.h"
 #include "../../io/include/logger.h"
 
 namespace co_uring
 {
 
     template <typename T>
-    class task
+    class task;
+
+    namespace detail
     {
-    public:
-        struct promise_type
+
+        // Fan-in point of when_all / when_any: a branch task reports here instead of
+        // resuming a continuation, and the group decides whom to resume
+        struct task_group
+        {
+            std::coroutine_handle<> (*on_branch_done)(task_group *group, std::size_t index) noexcept = nullptr;
+        };
+
+        // Shared by task<T> and task<void>: lazy start, continuation, exception slot, pooled frame
+        struct task_promise_base : pooled_frame
         {
-            task get_return_object()
+            // Resumed when the task finishes; a task nobody awaits just stops at final_suspend
+            std::coroutine_handle<> continuation_ = std::noop_coroutine();
+            std::exception_ptr exception_;
+            // Cancellation of the operation this task is waiting on; inherited from the awaiter
+            cancel_scope *cancel_scope_ = nullptr;
+            // Set while the task runs as a when_all / when_any branch
+            task_group *group_ = nullptr;
+            std::size_t group_index_ = 0;
+
+            // Lazy: the body runs when the task is first awaited
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            struct final_awaiter
             {
-                auto handle = std::coroutine_handle<promise_type>::from_promise(*this);
-                LOG_DEBUG("🔄 task<T> created - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle.address()));
-                return task{handle};
-            }
+                bool await_ready() noexcept { return false; }
 
-            std::suspend_never initial_suspend()
+                // Symmetric transfer: resume the awaiting coroutine as a tail call, so
+                // chains of awaits that complete synchronously do not grow the stack
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                {
+                    auto &promise = handle.promise();
+                    if (promise.group_ != nullptr)
+                    {
+                        return promise.group_->on_branch_done(promise.group_, promise.group_index_);
+                    }
+                    return promise.continuation_;
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            // Stay suspended at the end; the owning task destroys the frame
+            final_awaiter final_suspend() noexcept { return {}; }
+
+            void unhandled_exception() noexcept
             {
-                LOG_DEBUG("🚀 task<T> initial_suspend - starting immediately");
-                return {};
+                LOG_ERROR("💥 task unhandled_exception - storing exception");
+                exception_ = std::current_exception();
             }
+        };
 
-            std::suspend_never final_suspend() noexcept
+        template <typename Promise>
+        struct task_awaiter_base
+        {
+            std::coroutine_handle<Promise> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            // Record who to resume, then start the task on this thread without a nested resume().
+            // The task runs under the caller's cancel scope, so cancelling the caller reaches
+            // whatever the task is waiting on.
+            template <typename CallerPromise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<CallerPromise> caller) noexcept
             {
-                LOG_DEBUG("🏁 task<T> final_suspend - auto cleanup");
-                return {};
+                handle.promise().continuation_ = caller;
+                handle.promise().cancel_scope_ = cancel_scope_of(caller);
+                return handle;
             }
+        };
 
-            template <typename U>
-            void return_value(U &&value)
+    } // namespace detail
+
+    // Lazily started coroutine. Awaiting it runs the body and resumes the awaiter when
+    // the body finishes; the frame lives until the task object is destroyed.
+    template <typename T>
+    class task
+    {
+    public:
+        struct promise_type : detail::task_promise_base
+        {
+            task get_return_object() noexcept
             {
-                LOG_DEBUG("📤 task<T> return_value - coroutine returning value");
-                result_ = std::forward<U>(value);
+                return task{std::coroutine_handle<promise_type>::from_promise(*this)};
             }
 
-            void unhandled_exception()
+            template <typename U>
+            void return_value(U &&value)
             {
-                LOG_ERROR("💥 task<T> unhandled_exception - storing exception");
-                exception_ = std::current_exception();
+                result_.emplace(std::forward<U>(value));
             }
 
-            [[no_unique_address]] T result_{};
-            std::exception_ptr exception_;
+            std::optional<T> result_;
         };
 
         using handle_type = std::coroutine_handle<promise_type>;
 
         task() = default;
-        explicit task(handle_type h) : handle_(h)
-        {
-            if (h)
-            {
-                LOG_DEBUG("📦 task<T> constructor - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(h.address()));
-            }
-        }
+        explicit task(handle_type h) noexcept : handle_(h) {}
 
         task(const task &) = delete;
         task &operator=(const task &) = delete;
 
-        task(task &&other) noexcept : handle_(std::exchange(other.handle_, {}))
-        {
-            if (handle_)
-            {
-                LOG_DEBUG("📦 task<T> move constructor - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
-            }
-        }
+        task(task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
 
         task &operator=(task &&other) noexcept
         {
@@ -80,14 +130,9 @@ namespace co_uring
             {
                 if (handle_)
                 {
-                    LOG_DEBUG("🗑️ task<T> move assignment - destroying old handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
                     handle_.destroy();
                 }
                 handle_ = std::exchange(other.handle_, {});
-                if (handle_)
-                {
-                    LOG_DEBUG("📦 task<T> move assignment - new handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
-                }
             }
             return *this;
         }
@@ -96,77 +141,49 @@ namespace co_uring
         {
             if (handle_)
             {
-                LOG_DEBUG("🗑️ task<T> destructor - destroying handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
                 handle_.destroy();
             }
         }
 
-        bool done() const
-        {
-            bool is_done = handle_ && handle_.done();
-            LOG_DEBUG("❓ task<T> done() check - handle: 0x{:016x}, done: {}",
-                      handle_ ? reinterpret_cast<uintptr_t>(handle_.address()) : 0, is_done);
-            return is_done;
-        }
+        bool done() const noexcept { return handle_ && handle_.done(); }
 
+        // For combinators that start and collect the task themselves
+        [[nodiscard]] handle_type handle() const noexcept { return handle_; }
+
+        // Result of a finished task
         T get()
         {
-            if (!handle_)
+            if (!done())
             {
-                LOG_ERROR("❌ task<T> get() - invalid handle");
-                throw std::runtime_error("Invalid task handle");
+                LOG_ERROR("❌ task<T> get() - task has not finished");
+                throw std::runtime_error("task has not finished");
             }
-
             if (handle_.promise().exception_)
             {
-                LOG_ERROR("💥 task<T> get() - rethrowing stored exception");
                 std::rethrow_exception(handle_.promise().exception_);
             }
-
-            LOG_DEBUG("📤 task<T> get() - returning result");
-            return std::move(handle_.promise().result_);
+            return std::move(*handle_.promise().result_);
         }
 
-        auto operator co_await()
+        auto operator co_await() && noexcept
         {
-            struct awaiter
+            struct awaiter : detail::task_awaiter_base<promise_type>
             {
-                handle_type handle;
-
-                bool await_ready()
-                {
-                    bool ready = handle.done();
-                    LOG_DEBUG("❓ task<T> await_ready - handle: 0x{:016x}, ready: {}",
-                              reinterpret_cast<uintptr_t>(handle.address()), ready);
-                    return ready;
-                }
-
-                void await_suspend(std::coroutine_handle<> caller)
-                {
-                    LOG_DEBUG("⏸️ task<T> await_suspend - caller: 0x{:016x}, task: 0x{:016x}",
-                              reinterpret_cast<uintptr_t>(caller.address()),
-                              reinterpret_cast<uintptr_t>(handle.address()));
-                    // Simple fire-and-forget for now
-                }
-
                 T await_resume()
                 {
-                    LOG_DEBUG("▶️ task<T> await_resume - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle.address()));
-                    if (handle.promise().exception_)
+                    auto &promise = this->handle.promise();
+                    if (promise.exception_)
                     {
-                        LOG_ERROR("💥 task<T> await_resume - rethrowing stored exception");
-                        std::rethrow_exception(handle.promise().exception_);
+                        std::rethrow_exception(promise.exception_);
                     }
-                    LOG_DEBUG("📤 task<T> await_resume - returning result");
-                    return std::move(handle.promise().result_);
+                    return std::move(*promise.result_);
                 }
             };
-
-            LOG_DEBUG("🔄 task<T> co_await - creating awaiter for handle: 0x{:016x}",
-                      handle_ ? reinterpret_cast<uintptr_t>(handle_.address()) : 0);
-            return awaiter{handle_};
+            return awaiter{{handle_}};
         }
 
+        auto operator co_await() & noexcept { return std::move(*this).operator co_await(); }
+
     private:
         handle_type handle_;
     };
@@ -176,62 +193,25 @@ namespace co_uring
     class task<void>
     {
     public:
-        struct promise_type
+        struct promise_type : detail::task_promise_base
         {
-            task get_return_object()
+            task get_return_object() noexcept
             {
-                auto handle = std::coroutine_handle<promise_type>::from_promise(*this);
-                LOG_DEBUG("🔄 task<void> created - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle.address()));
-                return task{handle};
+                return task{std::coroutine_handle<promise_type>::from_promise(*this)};
             }
 
-            std::suspend_never initial_suspend()
-            {
-                LOG_DEBUG("🚀 task<void> initial_suspend - starting immediately");
-                return {};
-            }
-
-            std::suspend_never final_suspend() noexcept
-            {
-                LOG_DEBUG("🏁 task<void> final_suspend - auto cleanup");
-                return {};
-            }
-
-            void return_void()
-            {
-                LOG_DEBUG("📤 task<void> return_void - coroutine completed");
-            }
-
-            void unhandled_exception()
-            {
-                LOG_ERROR("💥 task<void> unhandled_exception - storing exception");
-                exception_ = std::current_exception();
-            }
-
-            std::exception_ptr exception_;
+            void return_void() noexcept {}
         };
 
         using handle_type = std::coroutine_handle<promise_type>;
 
         task() = default;
-        explicit task(handle_type h) : handle_(h)
-        {
-            if (h)
-            {
-                LOG_DEBUG("📦 task<void> constructor - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(h.address()));
-            }
-        }
+        explicit task(handle_type h) noexcept : handle_(h) {}
 
         task(const task &) = delete;
         task &operator=(const task &) = delete;
 
-        task(task &&other) noexcept : handle_(std::exchange(other.handle_, {}))
-        {
-            if (handle_)
-            {
-                LOG_DEBUG("📦 task<void> move constructor - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
-            }
-        }
+        task(task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
 
         task &operator=(task &&other) noexcept
         {
@@ -239,14 +219,9 @@ namespace co_uring
             {
                 if (handle_)
                 {
-                    LOG_DEBUG("🗑️ task<void> move assignment - destroying old handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
                     handle_.destroy();
                 }
                 handle_ = std::exchange(other.handle_, {});
-                if (handle_)
-                {
-                    LOG_DEBUG("📦 task<void> move assignment - new handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
-                }
             }
             return *this;
         }
@@ -255,92 +230,51 @@ namespace co_uring
         {
             if (handle_)
             {
-                LOG_DEBUG("🗑️ task<void> destructor - destroying handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle_.address()));
                 handle_.destroy();
             }
         }
 
-        bool done() const
-        {
-            bool is_done = handle_ && handle_.done();
-            LOG_DEBUG("❓ task<void> done() check - handle: 0x{:016x}, done: {}",
-                      handle_ ? reinterpret_cast<uintptr_t>(handle_.address()) : 0, is_done);
-            return is_done;
-        }
+        bool done() const noexcept { return handle_ && handle_.done(); }
+
+        // For combinators that start and collect the task themselves
+        [[nodiscard]] handle_type handle() const noexcept { return handle_; }
 
+        // Rethrow what a finished task threw
         void get()
         {
-            if (!handle_)
+            if (!done())
             {
-                LOG_ERROR("❌ task<void> get() - invalid handle");
-                throw std::runtime_error("Invalid task handle");
+                LOG_ERROR("❌ task<void> get() - task has not finished");
+                throw std::runtime_error("task has not finished");
             }
-
             if (handle_.promise().exception_)
             {
-                LOG_ERROR("💥 task<void> get() - rethrowing stored exception");
                 std::rethrow_exception(handle_.promise().exception_);
             }
-
-            LOG_DEBUG("✅ task<void> get() - completed successfully");
         }
 
-        auto operator co_await()
+        auto operator co_await() && noexcept
         {
-            struct awaiter
+            struct awaiter : detail::task_awaiter_base<promise_type>
             {
-                handle_type handle;
-
-                bool await_ready()
-                {
-                    bool ready = handle.done();
-                    LOG_DEBUG("❓ task<void> await_ready - handle: 0x{:016x}, ready: {}",
-                              reinterpret_cast<uintptr_t>(handle.address()), ready);
-                    return ready;
-                }
-
-                void await_suspend(std::coroutine_handle<> caller)
-                {
-                    LOG_DEBUG("⏸️ task<void> await_suspend - caller: 0x{:016x}, task: 0x{:016x}",
-                              reinterpret_cast<uintptr_t>(caller.address()),
-                              reinterpret_cast<uintptr_t>(handle.address()));
-                    // Simple fire-and-forget for now
-                }
-
                 void await_resume()
                 {
-                    LOG_DEBUG("▶️ task<void> await_resume - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(handle.address()));
-                    if (handle.promise().exception_)
+                    if (this->handle.promise().exception_)
                     {
-                        LOG_ERROR("💥 task<void> await_resume - rethrowing stored exception");
-                        std::rethrow_exception(handle.promise().exception_);
+                        std::rethrow_exception(this->handle.promise().exception_);
                     }
-                    LOG_DEBUG("✅ task<void> await_resume - completed successfully");
                 }
             };
-
-            LOG_DEBUG("🔄 task<void> co_await - creating awaiter for handle: 0x{:016x}",
-                      handle_ ? reinterpret_cast<uintptr_t>(handle_.address()) : 0);
-            return awaiter{handle_};
+            return awaiter{{handle_}};
         }
 
+        auto operator co_await() & noexcept { return std::move(*this).operator co_await(); }
+
     private:
         handle_type handle_;
     };
 
-    // Helper functions
-    template <typename T>
-    void wait(task<T> &t)
-    {
-        // Simple wait implementation
-        while (t.handle_ && !t.handle_.done())
-        {
-            // Busy wait for now - in real implementation this would yield
-            std::this_thread::yield();
-        }
-    }
-
     // Type alias for backward compatibility
     using simple_task = task<void>;
 
-} // namespace co_uring
\ No newline at end of file
+} // namespace co_uring
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "cancel_scope.h"
+#include "task.h"
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace co_uring
+{
+
+    namespace detail
+    {
+
+        template <typename T>
+        struct is_task : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct is_task<task<T>> : std::true_type
+        {
+        };
+
+        template <typename Task>
+        struct task_value;
+
+        template <typename T>
+        struct task_value<task<T>>
+        {
+            // void branches report std::monostate so every branch has a slot in the result
+            using type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+        };
+
+        template <typename Task>
+        using task_value_t = typename task_value<Task>::type;
+
+        // Runs a plain awaitable (recv, send, timer, stream next) as a branch; the wrapper
+        // frame comes from the per-thread frame pool
+        template <typename Awaitable>
+        auto as_task(Awaitable awaitable) -> task<decltype(awaitable.await_resume())>
+        {
+            co_return co_await awaitable;
+        }
+
+        template <typename Awaitable>
+        auto to_task(Awaitable awaitable)
+        {
+            if constexpr (is_task<Awaitable>::value)
+            {
+                return awaitable;
+            }
+            else
+            {
+                return as_task(std::move(awaitable));
+            }
+        }
+
+        template <typename Awaitable>
+        using to_task_t = decltype(to_task(std::declval<Awaitable>()));
+
+        // Branch bookkeeping shared by when_all and when_any. The awaiter lives in the
+        // awaiting coroutine's frame and starts the branches in place: no coroutine of its
+        // own and no allocation. Every branch is awaited to the end, losers included, so
+        // nothing still references a branch frame once the parent resumes.
+        template <typename... Tasks>
+        class when_group : protected task_group
+        {
+        protected:
+            static constexpr std::size_t COUNT = sizeof...(Tasks);
+
+            explicit when_group(Tasks... tasks) noexcept : tasks_(std::move(tasks)...) {}
+
+            // Movable until awaited, so a combinator can itself be a branch
+            when_group(when_group &&) noexcept = default;
+            when_group &operator=(when_group &&) = delete;
+
+            // Returns false if every branch finished synchronously
+            template <typename Promise>
+            bool start(std::coroutine_handle<Promise> parent,
+                       std::coroutine_handle<> (*on_done)(task_group *, std::size_t) noexcept)
+            {
+                parent_ = parent;
+                parent_scope_ = cancel_scope_of(parent);
+                on_branch_done = on_done;
+                // One extra count for ourselves, so no branch resumes the parent from inside this loop
+                remaining_ = COUNT + 1;
+                [this]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    (startBranch<I>(), ...);
+                }(std::index_sequence_for<Tasks...>{});
+
+                if (--remaining_ == 0)
+                {
+                    return false;
+                }
+                // Cancelling the parent cancels every branch still waiting
+                if (parent_scope_ != nullptr)
+                {
+                    parent_scope_->bind(&when_group::cancelAll, this);
+                }
+                return true;
+            }
+
+            // Called from a branch's final_suspend; the parent resumes after the last one
+            std::coroutine_handle<> finishBranch() noexcept
+            {
+                if (--remaining_ != 0)
+                {
+                    return std::noop_coroutine();
+                }
+                if (parent_scope_ != nullptr)
+                {
+                    parent_scope_->unbind();
+                }
+                return parent_;
+            }
+
+            void cancelExcept(std::size_t index) noexcept
+            {
+                for (std::size_t i = 0; i < COUNT; ++i)
+                {
+                    if (i != index)
+                    {
+                        scopes_[i].request();
+                    }
+                }
+            }
+
+            template <std::size_t I>
+            auto take()
+            {
+                using result_type = task_value_t<std::tuple_element_t<I, std::tuple<Tasks...>>>;
+                if constexpr (std::is_same_v<result_type, std::monostate>)
+                {
+                    std::get<I>(tasks_).get();
+                    return std::monostate{};
+                }
+                else
+                {
+                    return std::get<I>(tasks_).get();
+                }
+            }
+
+            static constexpr std::size_t NO_WINNER = std::numeric_limits<std::size_t>::max();
+            // Set by when_any; branches not yet started when it is set never start
+            std::size_t winner_ = NO_WINNER;
+
+        private:
+            template <std::size_t I>
+            void startBranch() noexcept
+            {
+                if (winner_ != NO_WINNER)
+                {
+                    --remaining_;
+                    return;
+                }
+                auto handle = std::get<I>(tasks_).handle();
+                auto &promise = handle.promise();
+                promise.group_ = this;
+                promise.group_index_ = I;
+                promise.cancel_scope_ = &scopes_[I];
+                handle.resume();
+            }
+
+            static void cancelAll(void *target) noexcept
+            {
+                static_cast<when_group *>(target)->cancelExcept(NO_WINNER);
+            }
+
+            std::tuple<Tasks...> tasks_;
+            std::array<cancel_scope, COUNT> scopes_{};
+            std::coroutine_handle<> parent_;
+            cancel_scope *parent_scope_ = nullptr;
+            std::size_t remaining_ = 0;
+        };
+
+        template <typename... Tasks>
+        class when_all_awaiter : when_group<Tasks...>
+        {
+            using base = when_group<Tasks...>;
+
+        public:
+            explicit when_all_awaiter(Tasks... tasks) noexcept : base(std::move(tasks)...) {}
+
+            [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            bool await_suspend(std::coroutine_handle<Promise> parent)
+            {
+                return this->start(parent, &when_all_awaiter::onBranchDone);
+            }
+
+            // Every branch's result in order; the first branch (by position) that threw rethrows
+            std::tuple<task_value_t<Tasks>...> await_resume()
+            {
+                return [this]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    return std::tuple<task_value_t<Tasks>...>{this->template take<I>()...};
+                }(std::index_sequence_for<Tasks...>{});
+            }
+
+        private:
+            static std::coroutine_handle<> onBranchDone(task_group *group, std::size_t) noexcept
+            {
+                return static_cast<when_all_awaiter *>(group)->finishBranch();
+            }
+        };
+
+        template <typename... Tasks>
+        class when_any_awaiter : when_group<Tasks...>
+        {
+            using base = when_group<Tasks...>;
+
+        public:
+            using result_type = std::variant<task_value_t<Tasks>...>;
+
+            explicit when_any_awaiter(Tasks... tasks) noexcept : base(std::move(tasks)...) {}
+
+            [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            bool await_suspend(std::coroutine_handle<Promise> parent)
+            {
+                return this->start(parent, &when_any_awaiter::onBranchDone);
+            }
+
+            // The first branch to finish, by index; its exception if it threw
+            result_type await_resume()
+            {
+                return [this]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    std::optional<result_type> result;
+                    (void)((this->winner_ == I && (result.emplace(std::in_place_index<I>, this->template take<I>()), true)) ||
+                           ...);
+                    return std::move(*result);
+                }(std::index_sequence_for<Tasks...>{});
+            }
+
+        private:
+            static std::coroutine_handle<> onBranchDone(task_group *group, std::size_t index) noexcept
+            {
+                auto *self = static_cast<when_any_awaiter *>(group);
+                if (self->winner_ == base::NO_WINNER)
+                {
+                    self->winner_ = index;
+                    // Losers complete with -ECANCELED (or their real result if it raced in)
+                    self->cancelExcept(index);
+                }
+                return self->finishBranch();
+            }
+        };
+
+    } // namespace detail
+
+    // co_await when_all(a, b, ...) runs every task or awaitable concurrently on this worker
+    // and resumes with a tuple of their results once all have finished.
+    template <typename... Awaitables>
+    [[nodiscard]] auto when_all(Awaitables &&...awaitables)
+    {
+        static_assert(sizeof...(Awaitables) > 0, "when_all needs at least one awaitable");
+        return detail::when_all_awaiter<detail::to_task_t<std::remove_cvref_t<Awaitables>>...>(
+            detail::to_task(std::remove_cvref_t<Awaitables>(std::forward<Awaitables>(awaitables)))...);
+    }
+
+    // co_await when_any(a, b, ...) resumes with a variant holding the first result; the
+    // other branches are cancelled (ASYNC_CANCEL for ring operations) and awaited before
+    // the caller resumes, so their buffers and sqe_data are no longer in use. A loser whose
+    // result raced in anyway has it destroyed with its task, so do not race awaitables whose
+    // result owns something (a recv_stream chunk holds ring buffers): consume those inside
+    // one branch and let the cancellation end that branch instead.
+    template <typename... Awaitables>
+    [[nodiscard]] auto when_any(Awaitables &&...awaitables)
+    {
+        static_assert(sizeof...(Awaitables) > 0, "when_any needs at least one awaitable");
+        return detail::when_any_awaiter<detail::to_task_t<std::remove_cvref_t<Awaitables>>...>(
+            detail::to_task(std::remove_cvref_t<Awaitables>(std::forward<Awaitables>(awaitables)))...);
+    }
+
+} // namespace co_uring
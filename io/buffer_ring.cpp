@@ -1,5 +1,6 @@
 #include "include/buffer_ring.h"
 #include "include/io_uring.h"
+#include "include/logger.h"
 #include <sys/mman.h>
 #include <stdexcept>
 #include <cstring>
@@ -12,53 +13,343 @@
 #include <liburing.h>
 #include <ranges>
 #include <unistd.h>
+#include <sys/uio.h>
 
 namespace co_uring {
 
-int BufferRing::registerBufRing() noexcept {
+// Buffer ids are 16-bit in the ring entry
+static constexpr std::uint32_t TOTAL_BUFFERS = BufferRing::firstBufId(BufferRing::SIZE_CLASSES.size());
+static_assert(TOTAL_BUFFERS <= 65536, "buffer ids must fit in 16 bits");
+
+static std::size_t ringBytes(std::uint32_t entries) noexcept {
     const std::size_t page_size = sysconf(_SC_PAGESIZE);
-    const std::size_t size = BUF_RING_SIZE * sizeof(io_uring_buf);
-    const std::size_t aligned_size = (size + page_size - 1) & ~(page_size - 1);
-    
-    void *buf_ring = mmap(nullptr, aligned_size, PROT_READ | PROT_WRITE,
-                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (buf_ring == MAP_FAILED) {
+    const std::size_t size = entries * sizeof(io_uring_buf);
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static constexpr std::size_t ARENA_BYTES = BufferRing::classOffset(BufferRing::SIZE_CLASSES.size());
+
+static const char *backingName(ArenaBacking backing) noexcept {
+    switch (backing) {
+    case ArenaBacking::HUGETLB:
+        return "hugetlb";
+    case ArenaBacking::TRANSPARENT_HUGEPAGES:
+        return "transparent hugepages";
+    case ArenaBacking::PAGES:
+        return "4K pages";
+    default:
+        return "none";
+    }
+}
+
+int BufferRing::mapArena(bool hugepages) noexcept {
+    arena_bytes_ = ARENA_BYTES;
+
+    if (hugepages) {
+        // Reserved huge pages: fails with ENOMEM when vm.nr_hugepages is too small
+        const std::size_t length = (ARENA_BYTES + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (mapping != MAP_FAILED) {
+            mapping_ = mapping;
+            mapping_bytes_ = length;
+            arena_ = static_cast<std::uint8_t *>(mapping);
+            backing_ = ArenaBacking::HUGETLB;
+            return 0;
+        }
+
+        // THP needs a 2 MiB aligned range: over-map, align, and advise before the first touch
+        const std::size_t padded = length + HUGE_PAGE_SIZE;
+        mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            return -errno;
+        }
+        const auto base = reinterpret_cast<std::uintptr_t>(mapping);
+        const auto aligned = (base + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+        mapping_ = mapping;
+        mapping_bytes_ = padded;
+        arena_ = reinterpret_cast<std::uint8_t *>(aligned);
+        backing_ = madvise(arena_, length, MADV_HUGEPAGE) == 0 ? ArenaBacking::TRANSPARENT_HUGEPAGES
+                                                                : ArenaBacking::PAGES;
+        // Prefault now so the first recvs do not take page faults
+        std::memset(arena_, 0, length);
+        return 0;
+    }
+
+    void *mapping = mmap(nullptr, ARENA_BYTES, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (mapping == MAP_FAILED) {
         return -errno;
     }
+    madvise(mapping, ARENA_BYTES, MADV_NOHUGEPAGE);
+    mapping_ = mapping;
+    mapping_bytes_ = ARENA_BYTES;
+    arena_ = static_cast<std::uint8_t *>(mapping);
+    backing_ = ArenaBacking::PAGES;
+    return 0;
+}
+
+int BufferRing::registerBufRing(const BufferRingOptions &options) noexcept {
+    auto &io_uring = IoUring::getInstance();
+
+    if (int result = mapArena(options.hugepages); result != 0) {
+        std::cerr << "Failed to map buffer arena: " << strerror(-result) << std::endl;
+        return result;
+    }
+    buffers_.assign(TOTAL_BUFFERS, buffer_state{});
+
+    for (std::size_t c = 0; c < SIZE_CLASSES.size(); ++c) {
+        const auto &cls = SIZE_CLASSES[c];
+        auto &g = groups_[c];
+
+        g.ring_bytes = ringBytes(cls.entries);
+        void *buf_ring = mmap(nullptr, g.ring_bytes, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf_ring == MAP_FAILED) {
+            return -errno;
+        }
+        g.ring = reinterpret_cast<io_uring_buf_ring *>(buf_ring);
 
-    buf_ring_ = reinterpret_cast<io_uring_buf_ring *>(buf_ring);
+        g.stats.group_id = groupId(c);
+        g.stats.buf_size = cls.buf_size;
+        g.stats.entries = cls.entries;
+
+        // All groups share one mode: try incremental on the first, keep whatever it got
+        int result = -EINVAL;
+        if (options.incremental && (c == 0 || incremental_)) {
+            result = io_uring.setupBufRing(g.ring, groupId(c), cls.entries, IoUring::PBUF_RING_INC);
+            incremental_ = result == 0;
+        }
+        if (!incremental_) {
+            result = io_uring.setupBufRing(g.ring, groupId(c), cls.entries);
+        }
+        if (result != 0) {
+            return result;
+        }
+
+        const std::uint32_t first = firstBufId(c);
+        g.slot_bids.resize(cls.entries);
+        for (std::uint32_t i = 0; i < cls.entries; ++i) {
+            io_uring_buf_ring_add(g.ring, borrowBuf(first + i).data(), cls.buf_size, first + i,
+                                  io_uring_buf_ring_mask(cls.entries), i);
+            g.slot_bids[i] = first + i;
+            buffers_[first + i].ring_pos = i;
+        }
+        io_uring_buf_ring_advance(g.ring, cls.entries);
+        g.tail = cls.entries;
+    }
+
+    bundles_ = options.bundles && !incremental_ && io_uring.hasFeature(IoUring::FEAT_RECVSEND_BUNDLE);
+
+    if (options.register_fixed) {
+        const iovec arena{arena_, arena_bytes_};
+        if (int index = io_uring.registerBuffers(std::span<const iovec>(&arena, 1)); index >= 0) {
+            fixed_buf_index_ = index;
+        }
+    }
+
+    std::cout << "Buffer rings registered: " << SIZE_CLASSES.size() << " groups, " << TOTAL_BUFFERS
+              << " buffers in a " << (arena_bytes_ >> 10) << " KiB arena (" << backingName(backing_) << ", "
+              << (incremental_ ? "incremental" : "whole-buffer") << " consumption"
+              << (bundles_ ? ", recv bundles" : "") << ")" << std::endl;
+    return 0;
+}
+
+std::size_t BufferRing::classForLength(std::uint32_t length) noexcept {
+    for (std::size_t c = 0; c < SIZE_CLASSES.size(); ++c) {
+        if (SIZE_CLASSES[c].buf_size >= length) {
+            return c;
+        }
+    }
+    return SIZE_CLASSES.size() - 1;
+}
+
+std::size_t BufferRing::classOf(std::uint32_t buf_id) noexcept {
+    for (std::size_t c = 1; c < SIZE_CLASSES.size(); ++c) {
+        if (buf_id < firstBufId(c)) {
+            return c - 1;
+        }
+    }
+    return SIZE_CLASSES.size() - 1;
+}
 
-    buf_list_.reserve(BUF_RING_SIZE);
-    for (unsigned i = 0; i < BUF_RING_SIZE; ++i) {
-        buf_list_.emplace_back(BUF_SIZE);
+std::uint32_t BufferRing::bufIdAt(const std::uint8_t *p) const noexcept {
+    if (arena_ == nullptr || p < arena_ || p >= arena_ + arena_bytes_) {
+        return NO_BUFFER;
+    }
+    const auto offset = static_cast<std::size_t>(p - arena_);
+    std::size_t c = 0;
+    while (c + 1 < SIZE_CLASSES.size() && offset >= classOffset(c + 1)) {
+        ++c;
     }
+    return firstBufId(c) + static_cast<std::uint32_t>((offset - classOffset(c)) / SIZE_CLASSES[c].buf_size);
+}
 
-    return IoUring::getInstance().setupBufRing(buf_ring_, buf_list_);
+std::span<std::uint8_t> BufferRing::borrowBuf(const std::uint32_t buf_id) noexcept {
+    const std::size_t c = classOf(buf_id);
+    const std::size_t size = SIZE_CLASSES[c].buf_size;
+    return {arena_ + classOffset(c) + (buf_id - firstBufId(c)) * size, size};
 }
 
-std::vector<std::uint8_t>& BufferRing::borrowBuf(const std::uint32_t buf_id) noexcept {
-    borrowed_buf_set_[buf_id] = true;
-    return buf_list_[buf_id];
+std::uint32_t BufferRing::noteSelected(std::uint32_t buf_id, std::uint32_t length,
+                                       std::uint32_t cqe_flags) noexcept {
+    auto &b = buffers_[buf_id];
+    auto &stats = groups_[classOf(buf_id)].stats;
+    const std::uint32_t offset = b.offset;
+
+    if (!b.held) {
+        b.held = true;
+        ++stats.in_use;
+        stats.peak_in_use = std::max(stats.peak_in_use, stats.in_use);
+    }
+    ++stats.selected;
+    ++b.slices;
+
+    if (incremental_) {
+        if (offset > 0) {
+            ++stats.packed;
+        }
+        b.offset += length;
+        b.kernel_done = (cqe_flags & IoUring::CQE_F_BUF_MORE) == 0;
+    } else {
+        b.kernel_done = true;
+    }
+    return offset;
 }
 
 void BufferRing::returnBuf(const std::uint32_t buf_id) noexcept {
-    borrowed_buf_set_[buf_id] = false;
-    IoUring::getInstance().addBuf(buf_ring_, buf_list_[buf_id].data(), buf_list_[buf_id].size(), buf_id);
+    auto &b = buffers_[buf_id];
+    if (b.slices > 0) {
+        --b.slices;
+    }
+    if (b.slices > 0 || !b.kernel_done) {
+        // Other recvs still read from it, or the kernel keeps filling the rest
+        return;
+    }
+
+    const std::size_t c = classOf(buf_id);
+    auto &g = groups_[c];
+    if (b.held) {
+        b.held = false;
+        --g.stats.in_use;
+    }
+    b.offset = 0;
+
+    const std::uint32_t mask = SIZE_CLASSES[c].entries - 1;
+    b.ring_pos = g.tail++;
+    g.slot_bids[b.ring_pos & mask] = buf_id;
+
+    auto buffer = borrowBuf(buf_id);
+    IoUring::getInstance().addBuf(g.ring, buffer.data(), buffer.size(), buf_id, SIZE_CLASSES[c].entries);
+
+    // One buffer back, one parked recv re-armed; it parks again if another recv wins the buffer
+    if (!g.parked.empty()) {
+        const parked_recv next = g.parked.front();
+        g.parked.pop_front();
+        g.stats.parked_now = g.parked.size();
+        next.wake(next.context);
+    }
+}
+
+std::uint32_t BufferRing::nextInRing(std::uint32_t buf_id) const noexcept {
+    const std::size_t c = classOf(buf_id);
+    const std::uint32_t pos = buffers_[buf_id].ring_pos + 1;
+    const std::uint32_t next = groups_[c].slot_bids[pos & (SIZE_CLASSES[c].entries - 1)];
+    // The slot is overwritten once the ring wraps past it; its buffer then carries a later position
+    return buffers_[next].ring_pos == pos ? next : NO_BUFFER;
+}
+
+std::uint32_t BufferRing::noteBundle(std::uint32_t first_id, std::uint32_t length) noexcept {
+    // Slots behind the kernel's head are refilled as buffers come back, so the ring mirror is
+    // only reliable now; the links keep the run intact until the consumer returns it
+    std::uint32_t count = 0;
+    std::uint32_t buf_id = first_id;
+    while (length > 0) {
+        if (buf_id == NO_BUFFER) {
+            LOG_ERROR("❌ recv bundle from buffer {} outran the ring mirror, {} bytes unresolved", first_id, length);
+            returnBufs(first_id, count);
+            return 0;
+        }
+        const std::uint32_t take = std::min(length, bufferSize(classOf(buf_id)));
+        noteSelected(buf_id, take, 0);
+        ++count;
+        length -= take;
+
+        const std::uint32_t next = length > 0 ? nextInRing(buf_id) : NO_BUFFER;
+        buffers_[buf_id].bundle_next = next;
+        buf_id = next;
+    }
+    return count;
+}
+
+void BufferRing::returnBufs(std::uint32_t first_id, std::uint32_t count) noexcept {
+    if (count <= 1) {
+        if (count == 1) {
+            returnBuf(first_id);
+        }
+        return;
+    }
+
+    std::uint32_t buf_id = first_id;
+    for (std::uint32_t i = 0; i < count && buf_id != NO_BUFFER; ++i) {
+        // Unlink first: returnBuf hands the buffer back to the kernel
+        const std::uint32_t next = buffers_[buf_id].bundle_next;
+        buffers_[buf_id].bundle_next = NO_BUFFER;
+        returnBuf(buf_id);
+        buf_id = next;
+    }
+}
+
+void BufferRing::park(std::size_t class_index, wake_fn wake, void *context) {
+    auto &g = groups_[class_index];
+    ++g.stats.enobufs;
+    ++g.stats.parked;
+    g.parked.push_back(parked_recv{wake, context});
+    g.stats.parked_now = g.parked.size();
+}
+
+void BufferRing::unpark(void *context) noexcept {
+    for (auto &g : groups_) {
+        std::erase_if(g.parked, [context](const parked_recv &p) { return p.context == context; });
+        g.stats.parked_now = g.parked.size();
+    }
+}
+
+BufferGroupStats BufferRing::groupStats(std::size_t class_index) const noexcept {
+    return groups_[class_index].stats;
+}
+
+void BufferRing::logStats() const {
+    for (const auto &g : groups_) {
+        const auto &s = g.stats;
+        LOG_INFO("📦 buffer group {} ({}B x {}): in use {}, peak {}, selected {}, packed {}, ENOBUFS {}, parked {}",
+                 s.group_id, s.buf_size, s.entries, s.in_use, s.peak_in_use, s.selected, s.packed, s.enobufs,
+                 s.parked_now);
+    }
 }
 
 BufferRing::~BufferRing() {
     try {
-        if (buf_ring_) {
-            const size_t page_size = sysconf(_SC_PAGESIZE);
-            const size_t size = BUF_RING_SIZE * sizeof(io_uring_buf);
-            const size_t aligned_size = (size + page_size - 1) & ~(page_size - 1);
-            munmap(buf_ring_, aligned_size);
-            buf_ring_ = nullptr;
-            std::cout << "BufferRing destroyed successfully" << std::endl;
+        for (auto &g : groups_) {
+            if (g.ring) {
+                munmap(g.ring, g.ring_bytes);
+                g.ring = nullptr;
+            }
+        }
+        if (fixed_buf_index_ >= 0) {
+            IoUring::getInstance().unregisterBuffers(static_cast<std::uint32_t>(fixed_buf_index_), 1);
+        }
+        if (mapping_) {
+            munmap(mapping_, mapping_bytes_);
+            mapping_ = nullptr;
+            arena_ = nullptr;
         }
+        std::cout << "BufferRing destroyed successfully" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Error during BufferRing destruction: " << e.what() << std::endl;
     }
 }
 
-} // namespace co_uring
\ No newline at end of file
+} // namespace co_uring
@@ -0,0 +1,34 @@
+#include "include/coarse_clock.h"
+#include "include/binary_log.h"
+
+namespace co_uring
+{
+
+    static_assert(CoarseClock::TIMESTAMP_LENGTH == binlog::TIMESTAMP_LENGTH);
+
+    CoarseClock &CoarseClock::getInstance() noexcept
+    {
+        thread_local CoarseClock instance;
+        return instance;
+    }
+
+    void CoarseClock::refresh() noexcept
+    {
+        steady_ = precise();
+        unix_ns_ = preciseUnixNanos();
+        active_ = true;
+    }
+
+    std::string_view CoarseClock::timestamp() noexcept
+    {
+        // Lines within the same millisecond share the text rendered for the first of them
+        const std::int64_t ms = unixNanos() / 1'000'000;
+        if (ms != rendered_ms_)
+        {
+            binlog::formatTimestamp(ms * 1'000'000, timestamp_);
+            rendered_ms_ = ms;
+        }
+        return {timestamp_, TIMESTAMP_LENGTH};
+    }
+
+} // namespace co_uring
@@ -0,0 +1,251 @@
+#include "include/compute_pool.h"
+#include "include/logger.h"
+#include <exception>
+
+namespace co_uring
+{
+
+    namespace
+    {
+        // Idle polls of the deques before a pool thread goes to sleep
+        constexpr int SPIN_ROUNDS = 64;
+        // Extra injected jobs a thread moves into its own deque, where others can steal them
+        constexpr std::size_t INJECT_BATCH = 8;
+
+        // Deque of the pool thread running on this thread, nullptr elsewhere
+        thread_local chase_lev_deque<compute_job> *current_deque = nullptr;
+    } // namespace
+
+    ComputePool &ComputePool::getInstance() noexcept
+    {
+        static ComputePool instance;
+        return instance;
+    }
+
+    ComputePool::~ComputePool()
+    {
+        stop();
+    }
+
+    bool ComputePool::start(std::size_t thread_count)
+    {
+        if (running_.load(std::memory_order_acquire) || thread_count == 0)
+        {
+            return false;
+        }
+
+        threads_.clear();
+        for (std::size_t i = 0; i < thread_count; ++i)
+        {
+            threads_.push_back(std::make_unique<pool_thread>());
+        }
+        running_.store(true, std::memory_order_release);
+        for (std::size_t i = 0; i < thread_count; ++i)
+        {
+            threads_[i]->thread = std::thread(&ComputePool::run, this, i);
+        }
+
+        LOG_INFO("🧮 ComputePool started with {} threads", thread_count);
+        return true;
+    }
+
+    void ComputePool::stop()
+    {
+        if (!running_.exchange(false, std::memory_order_acq_rel))
+        {
+            return;
+        }
+
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        epoch_.notify_all();
+        for (auto &t : threads_)
+        {
+            if (t->thread.joinable())
+            {
+                t->thread.join();
+            }
+        }
+
+        std::lock_guard lock(inject_mutex_);
+        if (!injected_.empty())
+        {
+            LOG_WARN("⚠️ ComputePool stopped with {} jobs never started", injected_.size());
+            injected_.clear();
+            injected_size_.store(0, std::memory_order_relaxed);
+        }
+        LOG_INFO("🧮 ComputePool stopped");
+    }
+
+    void ComputePool::submit(compute_job *job)
+    {
+        // Jobs spawned by jobs stay local; idle threads steal them
+        if (current_deque != nullptr)
+        {
+            current_deque->push(job);
+            wakeOne();
+            return;
+        }
+
+        {
+            std::lock_guard lock(inject_mutex_);
+            injected_.push_back(job);
+            injected_size_.fetch_add(1, std::memory_order_relaxed);
+        }
+        injected_total_.fetch_add(1, std::memory_order_relaxed);
+        wakeOne();
+    }
+
+    void ComputePool::wakeOne()
+    {
+        // Pairs with the sleeper's sleepers_ increment and epoch_ load (both seq_cst):
+        // either it sees the new epoch or we see it asleep
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0)
+        {
+            epoch_.notify_one();
+        }
+    }
+
+    void ComputePool::resumeOn(std::size_t worker_index, std::coroutine_handle<> handle)
+    {
+        if (!Mailbox::post(worker_index, [handle]()
+                           { handle.resume(); }))
+        {
+            LOG_ERROR("❌ ComputePool: worker {} is gone, offloaded coroutine cannot resume", worker_index);
+        }
+    }
+
+    compute_job *ComputePool::takeInjected(std::size_t index)
+    {
+        if (injected_size_.load(std::memory_order_relaxed) == 0)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard lock(inject_mutex_);
+        if (injected_.empty())
+        {
+            return nullptr;
+        }
+
+        compute_job *job = injected_.front();
+        injected_.pop_front();
+        std::size_t taken = 1;
+
+        // Spread a burst: park a few more locally so idle threads can steal them
+        auto &own = threads_[index]->deque;
+        while (!injected_.empty() && taken <= INJECT_BATCH)
+        {
+            own.push(injected_.front());
+            injected_.pop_front();
+            ++taken;
+        }
+        injected_size_.fetch_sub(taken, std::memory_order_relaxed);
+        if (taken > 1)
+        {
+            wakeOne();
+        }
+        return job;
+    }
+
+    compute_job *ComputePool::findWork(std::size_t index)
+    {
+        if (compute_job *job = threads_[index]->deque.pop())
+        {
+            return job;
+        }
+        if (compute_job *job = takeInjected(index))
+        {
+            return job;
+        }
+
+        const std::size_t count = threads_.size();
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            auto &victim = *threads_[(index + i) % count];
+            if (compute_job *job = victim.deque.steal())
+            {
+                threads_[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void ComputePool::run(std::size_t index)
+    {
+        // Wakebacks go through Mailbox::post, which sends MSG_RING synchronously from threads
+        // without an event loop and retries a failed one, so this thread needs no IoUring
+        auto &self = *threads_[index];
+        current_deque = &self.deque;
+        int idle_rounds = 0;
+
+        auto execute = [&self](compute_job *job)
+        {
+            try
+            {
+                job->run(job);
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("💥 Exception in compute job: {}", e.what());
+            }
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        while (running_.load(std::memory_order_acquire))
+        {
+            if (compute_job *job = findWork(index))
+            {
+                idle_rounds = 0;
+                execute(job);
+                continue;
+            }
+
+            if (++idle_rounds < SPIN_ROUNDS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce the sleep, then look once more so a racing submit is not missed
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            const std::uint32_t seen = epoch_.load(std::memory_order_seq_cst);
+            if (compute_job *job = findWork(index))
+            {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                idle_rounds = 0;
+                execute(job);
+                continue;
+            }
+            if (running_.load(std::memory_order_acquire))
+            {
+                epoch_.wait(seen, std::memory_order_seq_cst);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            idle_rounds = 0;
+        }
+        current_deque = nullptr;
+    }
+
+    ComputePoolStats ComputePool::getStats() const noexcept
+    {
+        ComputePoolStats stats;
+        stats.threads = threads_.size();
+        stats.injected = injected_total_.load(std::memory_order_relaxed);
+        for (const auto &t : threads_)
+        {
+            stats.executed += t->executed.load(std::memory_order_relaxed);
+            stats.stolen += t->stolen.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void ComputePool::logStats() const
+    {
+        const auto stats = getStats();
+        LOG_INFO("🧮 compute pool: {} threads, injected {}, executed {}, stolen {}", stats.threads, stats.injected,
+                 stats.executed, stats.stolen);
+    }
+
+} // namespace co_uring
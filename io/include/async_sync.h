@@ -0,0 +1,331 @@
+#pragma once
+
+#include "worker_waiter.h"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace co_uring
+{
+
+    class async_mutex;
+
+    // Owns a locked async_mutex and unlocks it on destruction
+    class async_lock_guard
+    {
+    public:
+        explicit async_lock_guard(async_mutex &mutex) noexcept : mutex_(&mutex) {}
+        async_lock_guard(async_lock_guard &&other) noexcept : mutex_(std::exchange(other.mutex_, nullptr)) {}
+        async_lock_guard(const async_lock_guard &) = delete;
+        async_lock_guard &operator=(const async_lock_guard &) = delete;
+        async_lock_guard &operator=(async_lock_guard &&) = delete;
+        inline ~async_lock_guard();
+
+    private:
+        async_mutex *mutex_;
+    };
+
+    // Mutex that suspends the coroutine, never the thread. The state word is either
+    // unlocked, locked, or the head of a stack of newly queued waiters; the holder
+    // reverses that stack into a FIFO on unlock and hands the lock straight to the
+    // oldest waiter, which resumes on its own worker. Waiting is a single CAS, and no
+    // lock is taken anywhere. Do not hold it across I/O: every waiter on every worker
+    // sits idle until unlock().
+    class async_mutex
+    {
+        class lock_awaiter;
+
+    public:
+        async_mutex() noexcept = default;
+        async_mutex(const async_mutex &) = delete;
+        async_mutex &operator=(const async_mutex &) = delete;
+
+        [[nodiscard]] bool try_lock() noexcept
+        {
+            std::uintptr_t expected = NOT_LOCKED;
+            return state_.compare_exchange_strong(expected, LOCKED_NO_WAITERS, std::memory_order_acquire,
+                                                  std::memory_order_relaxed);
+        }
+
+        // co_await mutex.lock(); ... mutex.unlock();
+        [[nodiscard]] lock_awaiter lock() noexcept { return lock_awaiter{*this}; }
+
+        // auto guard = co_await mutex.scoped_lock();
+        [[nodiscard]] auto scoped_lock() noexcept
+        {
+            struct scoped_awaiter : lock_awaiter
+            {
+                async_lock_guard await_resume() const noexcept { return async_lock_guard{this->mutex_}; }
+            };
+            return scoped_awaiter{lock_awaiter{*this}};
+        }
+
+        void unlock()
+        {
+            if (waiters_ == nullptr)
+            {
+                std::uintptr_t expected = LOCKED_NO_WAITERS;
+                if (state_.compare_exchange_strong(expected, NOT_LOCKED, std::memory_order_release,
+                                                   std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                // Take everyone queued since the last unlock, oldest first
+                auto *queued = reinterpret_cast<lock_awaiter *>(
+                    state_.exchange(LOCKED_NO_WAITERS, std::memory_order_acquire));
+                while (queued != nullptr)
+                {
+                    lock_awaiter *next = queued->next_;
+                    queued->next_ = waiters_;
+                    waiters_ = queued;
+                    queued = next;
+                }
+            }
+
+            // Ownership passes to the waiter without the state ever reading unlocked
+            lock_awaiter *next = waiters_;
+            waiters_ = next->next_;
+            next->waiter_.wake();
+        }
+
+    private:
+        static constexpr std::uintptr_t NOT_LOCKED = 1;
+        static constexpr std::uintptr_t LOCKED_NO_WAITERS = 0;
+
+        class lock_awaiter
+        {
+        public:
+            explicit lock_awaiter(async_mutex &mutex) noexcept : mutex_(mutex) {}
+
+            [[nodiscard]] bool await_ready() const noexcept { return mutex_.try_lock(); }
+
+            bool await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                waiter_.capture(handle);
+                std::uintptr_t old = mutex_.state_.load(std::memory_order_acquire);
+                while (true)
+                {
+                    if (old == NOT_LOCKED)
+                    {
+                        if (mutex_.state_.compare_exchange_weak(old, LOCKED_NO_WAITERS, std::memory_order_acquire,
+                                                                std::memory_order_acquire))
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+                    next_ = reinterpret_cast<lock_awaiter *>(old);
+                    if (mutex_.state_.compare_exchange_weak(old, reinterpret_cast<std::uintptr_t>(this),
+                                                            std::memory_order_release, std::memory_order_acquire))
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            void await_resume() const noexcept {}
+
+        protected:
+            friend class async_mutex;
+
+            async_mutex &mutex_;
+            lock_awaiter *next_ = nullptr;
+            detail::worker_waiter waiter_;
+        };
+
+        std::atomic<std::uintptr_t> state_{NOT_LOCKED};
+        // Holder only: waiters in FIFO order, already taken off state_
+        lock_awaiter *waiters_ = nullptr;
+    };
+
+    async_lock_guard::~async_lock_guard()
+    {
+        if (mutex_ != nullptr)
+        {
+            mutex_->unlock();
+        }
+    }
+
+    // Counting semaphore for coroutines, e.g. a per-worker cap on concurrent expensive
+    // operations. release() hands the permit straight to the oldest waiter. The internal
+    // std::mutex only guards the counter and the waiter list and is never held while a
+    // coroutine runs.
+    class async_semaphore
+    {
+        class acquire_awaiter;
+
+    public:
+        explicit async_semaphore(std::size_t permits) noexcept : permits_(permits) {}
+        async_semaphore(const async_semaphore &) = delete;
+        async_semaphore &operator=(const async_semaphore &) = delete;
+
+        [[nodiscard]] bool try_acquire() noexcept
+        {
+            std::lock_guard lock(mutex_);
+            if (permits_ == 0)
+            {
+                return false;
+            }
+            --permits_;
+            return true;
+        }
+
+        // co_await semaphore.acquire(); ... semaphore.release();
+        [[nodiscard]] acquire_awaiter acquire() noexcept { return acquire_awaiter{*this}; }
+
+        void release()
+        {
+            acquire_awaiter *next = nullptr;
+            {
+                std::lock_guard lock(mutex_);
+                if (head_ == nullptr)
+                {
+                    ++permits_;
+                    return;
+                }
+                next = head_;
+                head_ = next->next_;
+                if (head_ == nullptr)
+                {
+                    tail_ = nullptr;
+                }
+            }
+            next->waiter_.wake();
+        }
+
+        [[nodiscard]] std::size_t available() const noexcept
+        {
+            std::lock_guard lock(mutex_);
+            return permits_;
+        }
+
+    private:
+        class acquire_awaiter
+        {
+        public:
+            explicit acquire_awaiter(async_semaphore &semaphore) noexcept : semaphore_(semaphore) {}
+
+            [[nodiscard]] bool await_ready() const noexcept { return semaphore_.try_acquire(); }
+
+            bool await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                waiter_.capture(handle);
+                std::lock_guard lock(semaphore_.mutex_);
+                // A permit may have come back since await_ready
+                if (semaphore_.permits_ > 0)
+                {
+                    --semaphore_.permits_;
+                    return false;
+                }
+                if (semaphore_.tail_ != nullptr)
+                {
+                    semaphore_.tail_->next_ = this;
+                }
+                else
+                {
+                    semaphore_.head_ = this;
+                }
+                semaphore_.tail_ = this;
+                return true;
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            friend class async_semaphore;
+
+            async_semaphore &semaphore_;
+            acquire_awaiter *next_ = nullptr;
+            detail::worker_waiter waiter_;
+        };
+
+        mutable std::mutex mutex_;
+        std::size_t permits_;
+        acquire_awaiter *head_ = nullptr;
+        acquire_awaiter *tail_ = nullptr;
+    };
+
+    // Manual-reset event: co_await event.wait() passes once set() has been called, until
+    // reset(). The state word is either "set" or a lock-free stack of waiters; set()
+    // takes the whole stack at once and resumes each waiter on its own worker.
+    class async_event
+    {
+        class wait_awaiter;
+
+    public:
+        explicit async_event(bool initially_set = false) noexcept
+            : state_(initially_set ? static_cast<void *>(this) : nullptr) {}
+        async_event(const async_event &) = delete;
+        async_event &operator=(const async_event &) = delete;
+
+        [[nodiscard]] bool is_set() const noexcept { return state_.load(std::memory_order_acquire) == this; }
+
+        void set()
+        {
+            void *old = state_.exchange(this, std::memory_order_acq_rel);
+            if (old == this)
+            {
+                return;
+            }
+            auto *waiter = static_cast<wait_awaiter *>(old);
+            while (waiter != nullptr)
+            {
+                // The coroutine may run and drop its awaiter as soon as it is woken
+                wait_awaiter *next = waiter->next_;
+                waiter->waiter_.wake();
+                waiter = next;
+            }
+        }
+
+        // No effect unless the event is set
+        void reset() noexcept
+        {
+            void *expected = this;
+            state_.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] wait_awaiter wait() const noexcept { return wait_awaiter{*this}; }
+
+    private:
+        class wait_awaiter
+        {
+        public:
+            explicit wait_awaiter(const async_event &event) noexcept : event_(event) {}
+
+            [[nodiscard]] bool await_ready() const noexcept { return event_.is_set(); }
+
+            bool await_suspend(std::coroutine_handle<> handle) noexcept
+            {
+                waiter_.capture(handle);
+                void *old = event_.state_.load(std::memory_order_acquire);
+                do
+                {
+                    if (old == &event_)
+                    {
+                        return false;
+                    }
+                    next_ = static_cast<wait_awaiter *>(old);
+                } while (!event_.state_.compare_exchange_weak(old, this, std::memory_order_release,
+                                                              std::memory_order_acquire));
+                return true;
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            friend class async_event;
+
+            const async_event &event_;
+            wait_awaiter *next_ = nullptr;
+            detail::worker_waiter waiter_;
+        };
+
+        // this when set, otherwise the most recent waiter (nullptr if none)
+        mutable std::atomic<void *> state_;
+    };
+
+} // namespace co_uring
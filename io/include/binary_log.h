@@ -0,0 +1,595 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace co_uring
+{
+
+    // Binary log format shared by LogBackend (writer) and tools/logdecode (reader).
+    //
+    // A file is a stream of records, each starting with a one-byte type; integers are
+    // stored in host byte order. Each LOG_* call site is described once per file (format
+    // string, file, line, argument types), after which a call costs only its site id, a
+    // clock tick count and the raw argument bytes.
+    //
+    //   'H' magic[8]                                            start of a file
+    //   'D' u32 id, u8 level, u32 line, s16 file, s16 func, s16 format, s8 types
+    //   'C' u64 ticks, i64 unix_ns, f64 ticks_per_ns            clock sync point
+    //   'E' u32 id, u64 ticks, char thread[4], s16 payload      one log call
+    //   'T' u8 level, i64 unix_ns, char thread[4], s16 file, u32 line, s16 func, s16 text
+    //
+    // sN is a uN length followed by that many bytes.
+    //
+    // The text line format lives here too, so the decoder prints exactly what the text
+    // log would have and builds from this header alone.
+    namespace binlog
+    {
+
+        enum record_type : char
+        {
+            HEADER = 'H',
+            DESCRIPTOR = 'D',
+            CLOCK = 'C',
+            EVENT = 'E',
+            TEXT = 'T',
+        };
+
+        inline constexpr char MAGIC[8] = {'C', 'O', 'U', 'R', 'L', 'O', 'G', '1'};
+        inline constexpr std::size_t THREAD_TAG = 4;
+        // Argument bytes per call; must match log_record::text
+        inline constexpr std::size_t MAX_PAYLOAD = 216;
+
+        // One call site, as written in 'D' records
+        struct descriptor
+        {
+            std::uint32_t id = 0;
+            std::uint8_t level = 0;
+            std::uint32_t line = 0;
+            std::string file;
+            std::string func;
+            std::string format;
+            // One type code per argument, see type_code
+            std::string types;
+        };
+
+        // Cheapest monotonic tick counter: the TSC on x86, steady_clock nanoseconds elsewhere
+        inline std::uint64_t ticks() noexcept
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        inline std::int64_t unixNanos() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // Maps ticks to wall-clock time around one sync point
+        struct clock_sync
+        {
+            std::uint64_t ticks = 0;
+            std::int64_t unix_ns = 0;
+            double ticks_per_ns = 1.0;
+
+            [[nodiscard]] std::int64_t toUnixNanos(std::uint64_t t) const noexcept
+            {
+                const auto delta = static_cast<std::int64_t>(t - ticks);
+                return unix_ns + static_cast<std::int64_t>(static_cast<double>(delta) / ticks_per_ns);
+            }
+
+            // A new sync point now, keeping the measured rate
+            [[nodiscard]] clock_sync resync() const noexcept { return clock_sync{binlog::ticks(), unixNanos(), ticks_per_ns}; }
+        };
+
+        // Measures the tick rate against steady_clock over window; blocks for that long
+        inline clock_sync calibrate(std::chrono::milliseconds window)
+        {
+            const auto steady_start = std::chrono::steady_clock::now();
+            const std::uint64_t ticks_start = ticks();
+            std::this_thread::sleep_for(window);
+            const std::uint64_t ticks_end = ticks();
+            const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - steady_start);
+
+            clock_sync sync{ticks_end, unixNanos(), 1.0};
+            if (elapsed.count() > 0 && ticks_end > ticks_start)
+            {
+                sync.ticks_per_ns = static_cast<double>(ticks_end - ticks_start) / elapsed.count();
+            }
+            return sync;
+        }
+
+        // Argument type codes: b bool, c char, i signed, u unsigned, f double, p pointer,
+        // s string. Anything else (enums, thread ids, user types) is formatted at the call
+        // site with operator<< and stored as a string.
+        template <typename T>
+        constexpr char type_code() noexcept
+        {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (std::is_same_v<U, bool>)
+            {
+                return 'b';
+            }
+            else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> ||
+                               std::is_same_v<U, unsigned char>)
+            {
+                // ostream prints these as characters, so the decoder does too
+                return 'c';
+            }
+            else if constexpr (std::is_integral_v<U>)
+            {
+                return std::is_signed_v<U> ? 'i' : 'u';
+            }
+            else if constexpr (std::is_floating_point_v<U>)
+            {
+                return 'f';
+            }
+            else if constexpr (std::is_convertible_v<const U &, std::string_view>)
+            {
+                return 's';
+            }
+            else if constexpr (std::is_pointer_v<std::decay_t<U>>)
+            {
+                return 'p';
+            }
+            else
+            {
+                return 's';
+            }
+        }
+
+        template <typename... Args>
+        struct type_codes
+        {
+            static constexpr char value[sizeof...(Args) + 1] = {type_code<Args>()..., '\0'};
+        };
+
+        // Encodes call arguments into a fixed buffer. Strings are cut to fit; once something
+        // does not fit nothing more is written, and the decoder shows the rest as missing.
+        class payload_writer
+        {
+        public:
+            template <typename T>
+            void add(const T &value)
+            {
+                using U = std::remove_cvref_t<T>;
+                constexpr char code = type_code<T>();
+                if constexpr (code == 'b' || code == 'c')
+                {
+                    const auto byte = static_cast<std::uint8_t>(value);
+                    raw(&byte, sizeof(byte));
+                }
+                else if constexpr (code == 'i')
+                {
+                    const auto number = static_cast<std::int64_t>(value);
+                    raw(&number, sizeof(number));
+                }
+                else if constexpr (code == 'u')
+                {
+                    const auto number = static_cast<std::uint64_t>(value);
+                    raw(&number, sizeof(number));
+                }
+                else if constexpr (code == 'f')
+                {
+                    const auto number = static_cast<double>(value);
+                    raw(&number, sizeof(number));
+                }
+                else if constexpr (code == 'p')
+                {
+                    const auto address = reinterpret_cast<std::uintptr_t>(value);
+                    const auto number = static_cast<std::uint64_t>(address);
+                    raw(&number, sizeof(number));
+                }
+                else if constexpr (std::is_convertible_v<const U &, std::string_view>)
+                {
+                    if constexpr (std::is_pointer_v<std::decay_t<U>>)
+                    {
+                        if (value == nullptr)
+                        {
+                            string("(null)");
+                            return;
+                        }
+                    }
+                    string(std::string_view(value));
+                }
+                else
+                {
+                    std::ostringstream oss;
+                    oss << value;
+                    string(oss.str());
+                }
+            }
+
+            [[nodiscard]] const char *data() const noexcept { return data_; }
+            [[nodiscard]] std::size_t size() const noexcept { return size_; }
+            [[nodiscard]] bool truncated() const noexcept { return truncated_; }
+
+        private:
+            void raw(const void *bytes, std::size_t length) noexcept
+            {
+                if (truncated_ || size_ + length > MAX_PAYLOAD)
+                {
+                    truncated_ = true;
+                    return;
+                }
+                std::memcpy(data_ + size_, bytes, length);
+                size_ += length;
+            }
+
+            void string(std::string_view text) noexcept
+            {
+                if (truncated_ || size_ + sizeof(std::uint16_t) > MAX_PAYLOAD)
+                {
+                    truncated_ = true;
+                    return;
+                }
+                std::size_t length = std::min(text.size(), MAX_PAYLOAD - size_ - sizeof(std::uint16_t));
+                if (length < text.size())
+                {
+                    // Cut on a UTF-8 boundary
+                    while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80)
+                    {
+                        --length;
+                    }
+                    truncated_ = true;
+                }
+                const auto prefix = static_cast<std::uint16_t>(length);
+                std::memcpy(data_ + size_, &prefix, sizeof(prefix));
+                std::memcpy(data_ + size_ + sizeof(prefix), text.data(), length);
+                size_ += sizeof(prefix) + length;
+            }
+
+            char data_[MAX_PAYLOAD];
+            std::size_t size_ = 0;
+            bool truncated_ = false;
+        };
+
+        // Sequential reader over a record or payload; every read fails once the data runs out
+        class cursor
+        {
+        public:
+            explicit cursor(std::string_view data) noexcept : data_(data) {}
+
+            template <typename T>
+            bool read(T &value) noexcept
+            {
+                if (data_.size() < sizeof(T))
+                {
+                    return false;
+                }
+                std::memcpy(&value, data_.data(), sizeof(T));
+                data_.remove_prefix(sizeof(T));
+                return true;
+            }
+
+            template <typename Length = std::uint16_t>
+            bool readString(std::string_view &text) noexcept
+            {
+                Length length = 0;
+                if (!read(length) || data_.size() < length)
+                {
+                    return false;
+                }
+                text = data_.substr(0, length);
+                data_.remove_prefix(length);
+                return true;
+            }
+
+            bool readBytes(std::size_t length, std::string_view &bytes) noexcept
+            {
+                if (data_.size() < length)
+                {
+                    return false;
+                }
+                bytes = data_.substr(0, length);
+                data_.remove_prefix(length);
+                return true;
+            }
+
+            [[nodiscard]] std::size_t consumed(std::string_view from) const noexcept { return from.size() - data_.size(); }
+            [[nodiscard]] bool empty() const noexcept { return data_.empty(); }
+
+        private:
+            std::string_view data_;
+        };
+
+        // Record writers used by LogBackend
+
+        template <typename T>
+        void put(std::string &out, T value)
+        {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template <typename Length = std::uint16_t>
+        void putString(std::string &out, std::string_view text)
+        {
+            const auto length = static_cast<Length>(std::min<std::size_t>(text.size(), static_cast<Length>(-1)));
+            put(out, length);
+            out.append(text.data(), length);
+        }
+
+        inline void putThread(std::string &out, std::string_view thread)
+        {
+            char tag[THREAD_TAG] = {' ', ' ', ' ', ' '};
+            std::memcpy(tag, thread.data(), std::min(thread.size(), THREAD_TAG));
+            out.append(tag, THREAD_TAG);
+        }
+
+        inline void appendHeader(std::string &out)
+        {
+            out += HEADER;
+            out.append(MAGIC, sizeof(MAGIC));
+        }
+
+        inline void appendDescriptor(std::string &out, const descriptor &site)
+        {
+            out += DESCRIPTOR;
+            put(out, site.id);
+            put(out, site.level);
+            put(out, site.line);
+            putString(out, site.file);
+            putString(out, site.func);
+            putString(out, site.format);
+            putString<std::uint8_t>(out, site.types);
+        }
+
+        inline void appendClock(std::string &out, const clock_sync &sync)
+        {
+            out += CLOCK;
+            put(out, sync.ticks);
+            put(out, sync.unix_ns);
+            put(out, sync.ticks_per_ns);
+        }
+
+        inline void appendEvent(std::string &out, std::uint32_t id, std::uint64_t ticks, std::string_view thread,
+                                std::string_view payload)
+        {
+            out += EVENT;
+            put(out, id);
+            put(out, ticks);
+            putThread(out, thread);
+            putString(out, payload);
+        }
+
+        inline void appendText(std::string &out, std::uint8_t level, std::int64_t unix_ns, std::string_view thread,
+                               std::string_view file, std::uint32_t line, std::string_view func, std::string_view text)
+        {
+            out += TEXT;
+            put(out, level);
+            put(out, unix_ns);
+            putThread(out, thread);
+            putString(out, file);
+            put(out, line);
+            putString(out, func);
+            putString(out, text);
+        }
+
+        // Renders format with the encoded arguments, substituting each {} in turn like
+        // Logger::formatHelper; arguments left over are appended, space separated
+        inline void formatPayload(std::string &out, std::string_view format, std::string_view types,
+                                  std::string_view payload)
+        {
+            cursor in{payload};
+            char number[64];
+            for (const char code : types)
+            {
+                std::string_view piece = "…";
+                bool ok = true;
+                switch (code)
+                {
+                case 'b':
+                case 'c':
+                {
+                    std::uint8_t byte = 0;
+                    ok = in.read(byte);
+                    if (ok && code == 'b')
+                    {
+                        piece = byte != 0 ? "1" : "0";
+                    }
+                    else if (ok)
+                    {
+                        number[0] = static_cast<char>(byte);
+                        piece = std::string_view(number, 1);
+                    }
+                    break;
+                }
+                case 'i':
+                {
+                    std::int64_t value = 0;
+                    ok = in.read(value);
+                    if (ok)
+                    {
+                        piece = std::string_view(number, std::snprintf(number, sizeof(number), "%lld",
+                                                                       static_cast<long long>(value)));
+                    }
+                    break;
+                }
+                case 'u':
+                {
+                    std::uint64_t value = 0;
+                    ok = in.read(value);
+                    if (ok)
+                    {
+                        piece = std::string_view(number, std::snprintf(number, sizeof(number), "%llu",
+                                                                       static_cast<unsigned long long>(value)));
+                    }
+                    break;
+                }
+                case 'f':
+                {
+                    double value = 0;
+                    ok = in.read(value);
+                    if (ok)
+                    {
+                        piece = std::string_view(number, std::snprintf(number, sizeof(number), "%g", value));
+                    }
+                    break;
+                }
+                case 'p':
+                {
+                    std::uint64_t value = 0;
+                    ok = in.read(value);
+                    if (ok)
+                    {
+                        piece = std::string_view(number, std::snprintf(number, sizeof(number), "0x%llx",
+                                                                       static_cast<unsigned long long>(value)));
+                    }
+                    break;
+                }
+                default:
+                    ok = in.readString(piece);
+                    if (!ok)
+                    {
+                        piece = "…";
+                    }
+                    break;
+                }
+
+                const std::size_t pos = format.find("{}");
+                if (pos != std::string_view::npos)
+                {
+                    out.append(format.substr(0, pos));
+                    out.append(piece);
+                    format.remove_prefix(pos + 2);
+                }
+                else
+                {
+                    out += ' ';
+                    out.append(piece);
+                }
+            }
+            out.append(format);
+        }
+
+        // "YYYY-mm-dd HH:MM:SS.mmm"
+        inline constexpr std::size_t TIMESTAMP_LENGTH = 23;
+
+        // Writes unix_ns as local time into out (TIMESTAMP_LENGTH chars, not terminated);
+        // localtime runs only when the second differs from this thread's previous call
+        inline void formatTimestamp(std::int64_t unix_ns, char *out) noexcept
+        {
+            thread_local std::time_t cached_second = -1;
+            thread_local char cached_date[TIMESTAMP_LENGTH + 1];
+
+            const auto second = static_cast<std::time_t>(unix_ns / 1'000'000'000);
+            if (second != cached_second)
+            {
+                std::tm local{};
+                localtime_r(&second, &local);
+                // "YYYY-mm-dd HH:MM:SS" followed by ".mmm"
+                std::strftime(cached_date, sizeof(cached_date), "%Y-%m-%d %H:%M:%S", &local);
+                cached_date[19] = '.';
+                cached_second = second;
+            }
+            std::memcpy(out, cached_date, 20);
+
+            const auto millis = static_cast<int>(unix_ns / 1'000'000 % 1000);
+            out[20] = static_cast<char>('0' + millis / 100);
+            out[21] = static_cast<char>('0' + millis / 10 % 10);
+            out[22] = static_cast<char>('0' + millis % 10);
+        }
+
+        // level is a LogLevel value: 0 DEBUG, 1 INFO, 2 WARN, 3 ERROR
+        inline const char *levelName(std::uint8_t level) noexcept
+        {
+            switch (level)
+            {
+            case 0:
+                return "DEBUG";
+            case 1:
+                return "INFO ";
+            case 2:
+                return "WARN ";
+            case 3:
+                return "ERROR";
+            default:
+                return "UNKNOWN";
+            }
+        }
+
+        inline const char *colorCode(std::uint8_t level) noexcept
+        {
+            switch (level)
+            {
+            case 0:
+                return "\033[36m"; // Cyan
+            case 1:
+                return "\033[32m"; // Green
+            case 2:
+                return "\033[33m"; // Yellow
+            case 3:
+                return "\033[31m"; // Red
+            default:
+                return "\033[0m"; // Reset
+            }
+        }
+
+        // Appends one text log line with its newline:
+        //   [timestamp] [LEVEL] [T:thread] [file:line func()] message
+        // The location is left out when file is empty or line is not positive.
+        inline void appendLine(std::string &out, std::string_view timestamp, std::uint8_t level,
+                               std::string_view thread, std::string_view file, std::int32_t line,
+                               std::string_view func, std::string_view message, bool color)
+        {
+            if (color)
+            {
+                out += colorCode(level);
+            }
+            out += '[';
+            out += timestamp;
+            out += "] [";
+            out += levelName(level);
+            out += "] [T:";
+            out += thread;
+            out += "] ";
+
+            // [file:line func()] with the directory stripped
+            if (!file.empty() && line > 0)
+            {
+                if (const std::size_t slash = file.rfind('/'); slash != std::string_view::npos)
+                {
+                    file.remove_prefix(slash + 1);
+                }
+                out += '[';
+                out += file;
+                out += ':';
+                out += std::to_string(line);
+                if (!func.empty())
+                {
+                    out += ' ';
+                    out += func;
+                    out += "()";
+                }
+                out += "] ";
+            }
+
+            out += message;
+            if (color)
+            {
+                out += "\033[0m";
+            }
+            out += '\n';
+        }
+
+    } // namespace binlog
+
+} // namespace co_uring
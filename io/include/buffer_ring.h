@@ -1,9 +1,13 @@
 #pragma once
 
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <span>
 #include <vector>
 #include <liburing.h>
 #include <cstdint>
+#include <cstddef>
 #include <memory>
 
 namespace co_uring
@@ -11,13 +15,70 @@ namespace co_uring
 
     class IoUring;
 
+    // Occupancy of one provided-buffer group
+    struct BufferGroupStats
+    {
+        std::uint16_t group_id = 0;
+        std::uint32_t buf_size = 0;
+        std::uint32_t entries = 0;
+        // Buffers handed out by the kernel and not yet returned
+        std::uint32_t in_use = 0;
+        std::uint32_t peak_in_use = 0;
+        std::uint64_t selected = 0;
+        // Recvs that landed behind an earlier one in the same buffer (incremental mode)
+        std::uint64_t packed = 0;
+        // Recvs that found the group empty, and those parked until a buffer came back
+        std::uint64_t enobufs = 0;
+        std::uint64_t parked = 0;
+        std::size_t parked_now = 0;
+    };
+
+    struct BufferRingOptions
+    {
+        // Back the buffer arena with huge pages: MAP_HUGETLB if pages are reserved,
+        // else transparent huge pages, else regular pages
+        bool hugepages = true;
+        // Also register the arena as a fixed buffer, so received bytes can be sent
+        // with IORING_RECVSEND_FIXED_BUF without copying them into a send pool first
+        bool register_fixed = false;
+        // Consume buffers incrementally (IOU_PBUF_RING_INC, 6.12+): each recv takes only the
+        // bytes it needs and the rest of the buffer serves later recvs. Falls back to one
+        // buffer per recv on older kernels.
+        bool incremental = true;
+        // Recv bundles (IORING_RECVSEND_BUNDLE, 6.10+): one CQE hands over a run of buffers.
+        // Used only without incremental consumption, which wins when the kernel has both.
+        bool bundles = true;
+    };
+
+    // What the buffer arena ended up mapped with
+    enum class ArenaBacking
+    {
+        NONE,
+        HUGETLB,
+        TRANSPARENT_HUGEPAGES,
+        PAGES
+    };
+
     class BufferRing
     {
     public:
-        static constexpr unsigned IO_BUFFER_SIZE = 4096;
-        static constexpr unsigned NUM_IO_BUFFERS = 256;
-        static constexpr unsigned BUF_RING_SIZE = 1024;
-        static constexpr unsigned BUF_SIZE = 8192;
+        struct size_class
+        {
+            std::uint32_t buf_size;
+            // Power of two, as the kernel requires for ring entries
+            std::uint32_t entries;
+        };
+
+        // One provided-buffer group per class: small movement/input packets, regular
+        // packets, and bulk transfers. Buffer ids are unique across groups.
+        static constexpr std::array<size_class, 3> SIZE_CLASSES{{
+            {512, 2048},
+            {4096, 512},
+            {65536, 32},
+        }};
+        static constexpr std::uint16_t FIRST_GROUP_ID = 1;
+        // Class a new recv starts in before any traffic is seen
+        static constexpr std::size_t DEFAULT_CLASS = 1;
 
         BufferRing() = default;
         ~BufferRing();
@@ -29,28 +90,172 @@ namespace co_uring
             return instance;
         }
 
-        // Initialize buffer ring (call once)
-        int registerBufRing() noexcept;
+        // Map the buffer arena and register every group with this thread's ring (call once)
+        int registerBufRing(const BufferRingOptions &options = {}) noexcept;
 
         // Delete copy operations
         BufferRing(const BufferRing &) = delete;
         BufferRing &operator=(const BufferRing &) = delete;
 
+        [[nodiscard]] static constexpr std::uint16_t groupId(std::size_t class_index) noexcept
+        {
+            return static_cast<std::uint16_t>(FIRST_GROUP_ID + class_index);
+        }
+        [[nodiscard]] static constexpr std::uint32_t bufferSize(std::size_t class_index) noexcept
+        {
+            return SIZE_CLASSES[class_index].buf_size;
+        }
+        // Buffer ids of a class are [firstBufId(c), firstBufId(c) + entries)
+        [[nodiscard]] static constexpr std::uint32_t firstBufId(std::size_t class_index) noexcept
+        {
+            std::uint32_t first = 0;
+            for (std::size_t i = 0; i < class_index; ++i)
+            {
+                first += SIZE_CLASSES[i].entries;
+            }
+            return first;
+        }
+
+        // Byte offset of a class's buffers in the arena
+        [[nodiscard]] static constexpr std::size_t classOffset(std::size_t class_index) noexcept
+        {
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i < class_index; ++i)
+            {
+                offset += static_cast<std::size_t>(SIZE_CLASSES[i].buf_size) * SIZE_CLASSES[i].entries;
+            }
+            return offset;
+        }
+
+        // Smallest class whose buffers hold length bytes, the largest class otherwise
+        [[nodiscard]] static std::size_t classForLength(std::uint32_t length) noexcept;
+        // Class a buffer id belongs to
+        [[nodiscard]] static std::size_t classOf(std::uint32_t buf_id) noexcept;
+
         // Borrow buffer by ID
-        std::vector<std::uint8_t> &borrowBuf(const std::uint32_t buf_id) noexcept;
+        std::span<std::uint8_t> borrowBuf(const std::uint32_t buf_id) noexcept;
+        // Bytes of one recv: in incremental mode several recvs share a buffer at different offsets
+        std::span<std::uint8_t> borrowSlice(std::uint32_t buf_id, std::uint32_t offset, std::uint32_t length) noexcept
+        {
+            return borrowBuf(buf_id).subspan(offset, length);
+        }
 
-        // Return buffer by ID
+        // Release one slice of a buffer. The buffer goes back to its ring, waking one recv
+        // parked on the group, once every slice is released and the kernel is done with it.
         void returnBuf(const std::uint32_t buf_id) noexcept;
 
+        // Record that a CQE handed length bytes of this buffer to userspace; returns the offset
+        // of those bytes in the buffer (always 0 without incremental consumption)
+        std::uint32_t noteSelected(std::uint32_t buf_id, std::uint32_t length, std::uint32_t cqe_flags) noexcept;
+
+        // Bundle CQE: length bytes in consecutive ring buffers starting at first_id. Call when the
+        // CQE arrives: it resolves the run through the ring mirror while that is still accurate
+        // and links the buffers to each other. Returns how many there are, 0 if unresolvable.
+        std::uint32_t noteBundle(std::uint32_t first_id, std::uint32_t length) noexcept;
+        // Buffer after buf_id in the bundle it arrived in; stays valid until the bundle is
+        // returned, however often the ring slots are reused meanwhile
+        [[nodiscard]] std::uint32_t nextInBundle(std::uint32_t buf_id) const noexcept
+        {
+            return buffers_[buf_id].bundle_next;
+        }
+        static constexpr std::uint32_t NO_BUFFER = ~0U;
+
+        // Call fn(span) for each buffer's bytes of a recv of length bytes spanning count buffers
+        template <typename Fn>
+        void forEachSlice(std::uint32_t first_id, std::uint32_t offset, std::uint32_t length, std::uint32_t count,
+                          Fn &&fn)
+        {
+            std::uint32_t buf_id = first_id;
+            for (std::uint32_t i = 0; i < count && length > 0 && buf_id != NO_BUFFER; ++i)
+            {
+                const std::uint32_t take = std::min(length, bufferSize(classOf(buf_id)) - offset);
+                fn(borrowSlice(buf_id, offset, take));
+                length -= take;
+                offset = 0;
+                buf_id = i + 1 < count ? nextInBundle(buf_id) : NO_BUFFER;
+            }
+        }
+
+        // returnBuf() for every buffer of a bundle
+        void returnBufs(std::uint32_t first_id, std::uint32_t count) noexcept;
+
+        // Keep a handed-out buffer past its recv's returnBuf(), e.g. while a send reads from it;
+        // release it with one more returnBuf()
+        void retainBuf(std::uint32_t buf_id) noexcept { ++buffers_[buf_id].slices; }
+        // Buffer whose bytes contain p, NO_BUFFER if p is outside the arena
+        [[nodiscard]] std::uint32_t bufIdAt(const std::uint8_t *p) const noexcept;
+
+        // Park a recv that got -ENOBUFS; wake(context) runs once a buffer of the class returns
+        using wake_fn = void (*)(void *context);
+        void park(std::size_t class_index, wake_fn wake, void *context);
+        // Drop a parked recv that is going away
+        void unpark(void *context) noexcept;
+
+        [[nodiscard]] BufferGroupStats groupStats(std::size_t class_index) const noexcept;
+        void logStats() const;
+
+        [[nodiscard]] ArenaBacking arenaBacking() const noexcept { return backing_; }
+        // Whether the kernel accepted IOU_PBUF_RING_INC
+        [[nodiscard]] bool isIncremental() const noexcept { return incremental_; }
+        // Whether recvs should ask for bundles
+        [[nodiscard]] bool bundlesEnabled() const noexcept { return bundles_; }
+        // Registered buffer index of the arena, -1 unless registered with register_fixed
+        [[nodiscard]] int fixedBufIndex() const noexcept { return fixed_buf_index_; }
+
         // Check if initialized
-        auto isInitialized() const noexcept -> bool { return buf_ring_ != nullptr; }
+        auto isInitialized() const noexcept -> bool { return groups_[0].ring != nullptr; }
 
     private:
-        auto decodeVoid(int result) noexcept -> int;
+        struct parked_recv
+        {
+            wake_fn wake;
+            void *context;
+        };
+
+        struct buffer_state
+        {
+            // Where the kernel writes the next recv into this buffer
+            std::uint32_t offset = 0;
+            // Slices handed out and not yet returned
+            std::uint16_t slices = 0;
+            // Last CQE lacked IORING_CQE_F_BUF_MORE: the kernel will not write here again
+            bool kernel_done = true;
+            bool held = false;
+            // Absolute ring position it was last added at; bundles walk positions forward
+            std::uint32_t ring_pos = 0;
+            // Next buffer of the bundle CQE this one arrived in, captured by noteBundle
+            std::uint32_t bundle_next = NO_BUFFER;
+        };
+
+        struct group
+        {
+            io_uring_buf_ring *ring = nullptr;
+            std::size_t ring_bytes = 0;
+            // Buffers added so far, and which buffer id each ring slot was last given
+            std::uint32_t tail = 0;
+            std::vector<std::uint32_t> slot_bids;
+            // FIFO: each returned buffer wakes the oldest, so the front pop must be O(1)
+            std::deque<parked_recv> parked;
+            BufferGroupStats stats;
+        };
+
+        int mapArena(bool hugepages) noexcept;
+        // Buffer that followed buf_id in its ring, NO_BUFFER if that slot was reused since
+        [[nodiscard]] std::uint32_t nextInRing(std::uint32_t buf_id) const noexcept;
 
-        std::bitset<BUF_RING_SIZE> borrowed_buf_set_;
-        std::vector<std::vector<std::uint8_t>> buf_list_;
-        io_uring_buf_ring *buf_ring_{nullptr};
+        std::array<group, SIZE_CLASSES.size()> groups_;
+        // Every buffer of every class in one mapping; a buffer id maps to an offset by arithmetic
+        std::uint8_t *arena_ = nullptr;
+        std::size_t arena_bytes_ = 0;
+        // Start of the mmap call, which may precede arena_ by the alignment slack
+        void *mapping_ = nullptr;
+        std::size_t mapping_bytes_ = 0;
+        ArenaBacking backing_ = ArenaBacking::NONE;
+        bool incremental_ = false;
+        bool bundles_ = false;
+        // Indexed by buffer id
+        std::vector<buffer_state> buffers_;
+        int fixed_buf_index_ = -1;
     };
 
-} // namespace co_uring
\ No newline at end of file
+} // namespace co_uring
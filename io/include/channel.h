@@ -0,0 +1,441 @@
+#pragma once
+
+#include "scheduler.h"
+#include "worker_waiter.h"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace co_uring
+{
+
+    namespace detail
+    {
+
+        inline std::size_t channel_capacity(std::size_t capacity) noexcept
+        {
+            std::size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            return size;
+        }
+
+    } // namespace detail
+
+    // Bounded channel between two coroutines on the same worker. Both ends live on one
+    // thread, so the ring needs no atomics; a blocked end is parked until the other side
+    // reschedules it through the worker's ready queue, so waiting costs nothing.
+    // One sender and one receiver may wait at a time.
+    template <typename T>
+    class spsc_channel
+    {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 256;
+
+        explicit spsc_channel(std::size_t capacity = DEFAULT_CAPACITY)
+            : slots_(detail::channel_capacity(capacity)), mask_(slots_.size() - 1) {}
+
+        spsc_channel(const spsc_channel &) = delete;
+        spsc_channel &operator=(const spsc_channel &) = delete;
+
+        // Moves value in if there is room and the channel is open
+        bool try_send(T &value)
+        {
+            if (closed_ || tail_ - head_ == slots_.size())
+            {
+                return false;
+            }
+            slots_[tail_ & mask_].emplace(std::move(value));
+            ++tail_;
+            wake(receiver_);
+            return true;
+        }
+
+        std::optional<T> try_recv()
+        {
+            if (head_ == tail_)
+            {
+                return std::nullopt;
+            }
+            auto &slot = slots_[head_ & mask_];
+            std::optional<T> value{std::move(*slot)};
+            slot.reset();
+            ++head_;
+            wake(sender_);
+            return value;
+        }
+
+        class send_awaiter
+        {
+        public:
+            send_awaiter(spsc_channel &channel, T value) : channel_(channel), value_(std::move(value)) {}
+
+            bool await_ready()
+            {
+                sent_ = channel_.try_send(value_);
+                return sent_ || channel_.closed_;
+            }
+            void await_suspend(std::coroutine_handle<> handle) noexcept { channel_.sender_ = handle; }
+            // false if the channel was closed before the value went in
+            bool await_resume()
+            {
+                if (!sent_)
+                {
+                    // Woken for room or for close; only this sender fills the ring
+                    sent_ = channel_.try_send(value_);
+                }
+                return sent_;
+            }
+
+        private:
+            spsc_channel &channel_;
+            T value_;
+            bool sent_ = false;
+        };
+
+        class recv_awaiter
+        {
+        public:
+            explicit recv_awaiter(spsc_channel &channel) noexcept : channel_(channel) {}
+
+            bool await_ready()
+            {
+                value_ = channel_.try_recv();
+                return value_.has_value() || channel_.closed_;
+            }
+            void await_suspend(std::coroutine_handle<> handle) noexcept { channel_.receiver_ = handle; }
+            // nullopt once the channel is closed and drained
+            std::optional<T> await_resume()
+            {
+                if (!value_)
+                {
+                    value_ = channel_.try_recv();
+                }
+                return std::move(value_);
+            }
+
+        private:
+            spsc_channel &channel_;
+            std::optional<T> value_;
+        };
+
+        [[nodiscard]] send_awaiter send(T value) { return send_awaiter{*this, std::move(value)}; }
+        [[nodiscard]] recv_awaiter recv() noexcept { return recv_awaiter{*this}; }
+
+        // Further sends fail; the receiver still drains what is queued
+        void close()
+        {
+            closed_ = true;
+            wake(receiver_);
+            wake(sender_);
+        }
+
+        [[nodiscard]] bool closed() const noexcept { return closed_; }
+        [[nodiscard]] std::size_t size() const noexcept { return tail_ - head_; }
+        [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+
+    private:
+        static void wake(std::coroutine_handle<> &waiter)
+        {
+            if (waiter)
+            {
+                Scheduler::getInstance().schedule(std::exchange(waiter, {}));
+            }
+        }
+
+        std::vector<std::optional<T>> slots_;
+        const std::size_t mask_;
+        std::uint64_t head_ = 0;
+        std::uint64_t tail_ = 0;
+        std::coroutine_handle<> sender_;
+        std::coroutine_handle<> receiver_;
+        bool closed_ = false;
+    };
+
+    // Bounded channel with senders on any worker and one receiving coroutine. Slots carry
+    // Vyukov sequence numbers, so senders claim them with one CAS and no lock. A blocked
+    // receiver waits for one slot, the next in order, and only the sender that publishes
+    // that slot wakes it (on its own worker, through the Mailbox when the sender runs
+    // elsewhere); close() wakes it only when no claimed slot is still being written. A
+    // wake therefore always finds a value or the end of the stream, never a half-written
+    // slot. Senders that find the ring full queue up; the receiver moves their values in
+    // as it frees slots, oldest first, then wakes them.
+    // recv and blocking send must run on worker threads; try_send works from anywhere.
+    template <typename T>
+    class mpsc_channel
+    {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+
+        explicit mpsc_channel(std::size_t capacity = DEFAULT_CAPACITY)
+            : capacity_(detail::channel_capacity(capacity)), mask_(capacity_ - 1),
+              slots_(std::make_unique<slot[]>(capacity_))
+        {
+            for (std::size_t i = 0; i < capacity_; ++i)
+            {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpsc_channel(const mpsc_channel &) = delete;
+        mpsc_channel &operator=(const mpsc_channel &) = delete;
+
+        // Any thread; moves value in if there is room and the channel is open
+        bool try_send(T &value)
+        {
+            std::uint64_t pos = 0;
+            if (!enqueue(value, pos))
+            {
+                return false;
+            }
+            notifyReceiver(pos);
+            return true;
+        }
+
+        // Receiver only
+        std::optional<T> try_recv()
+        {
+            const std::uint64_t head = head_.load(std::memory_order_relaxed);
+            slot &s = slots_[head & mask_];
+            if (s.sequence.load(std::memory_order_acquire) != head + 1)
+            {
+                return std::nullopt;
+            }
+            std::optional<T> value{std::move(*s.value)};
+            s.value.reset();
+            s.sequence.store(head + capacity_, std::memory_order_release);
+            head_.store(head + 1, std::memory_order_relaxed);
+
+            // Pairs with the fence in send_awaiter::await_suspend
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (blocked_senders_.load(std::memory_order_relaxed) > 0)
+            {
+                admitSenders();
+            }
+            return value;
+        }
+
+        class send_awaiter
+        {
+        public:
+            send_awaiter(mpsc_channel &channel, T value) : channel_(channel), value_(std::move(value)) {}
+
+            bool await_ready()
+            {
+                sent_ = channel_.try_send(value_);
+                return sent_ || channel_.closed();
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                waiter_.capture(handle);
+                std::lock_guard lock(channel_.senders_mutex_);
+                // Announce first, then look again: either the receiver sees us or we see its free slot
+                channel_.blocked_senders_.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (channel_.closed())
+                {
+                    channel_.blocked_senders_.fetch_sub(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (std::uint64_t pos = 0; channel_.enqueue(value_, pos))
+                {
+                    channel_.blocked_senders_.fetch_sub(1, std::memory_order_relaxed);
+                    sent_ = true;
+                    channel_.notifyReceiver(pos);
+                    return false;
+                }
+                channel_.senders_.push_back(this);
+                return true;
+            }
+
+            // false if the channel was closed before the value went in
+            bool await_resume() noexcept { return sent_; }
+
+        private:
+            friend class mpsc_channel;
+
+            mpsc_channel &channel_;
+            T value_;
+            detail::worker_waiter waiter_;
+            bool sent_ = false;
+        };
+
+        class recv_awaiter
+        {
+        public:
+            explicit recv_awaiter(mpsc_channel &channel) noexcept : channel_(channel) {}
+
+            bool await_ready()
+            {
+                value_ = channel_.try_recv();
+                return value_.has_value() || channel_.drained();
+            }
+
+            // A claimed slot that is not written yet is waited for like an empty one: its
+            // sender wakes us once it is published
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                channel_.receiver_.capture(handle);
+                channel_.receiver_waiting_.store(true, std::memory_order_release);
+                // Pairs with the fence in notifyReceiver
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (channel_.published() || channel_.drained())
+                {
+                    // If a sender already took the wakeup, it is on its way; wait for it
+                    return !channel_.receiver_waiting_.exchange(false, std::memory_order_acq_rel);
+                }
+                return true;
+            }
+
+            // nullopt once the channel is closed and drained
+            std::optional<T> await_resume()
+            {
+                if (!value_)
+                {
+                    value_ = channel_.try_recv();
+                }
+                return std::move(value_);
+            }
+
+        private:
+            mpsc_channel &channel_;
+            std::optional<T> value_;
+        };
+
+        [[nodiscard]] send_awaiter send(T value) { return send_awaiter{*this, std::move(value)}; }
+        [[nodiscard]] recv_awaiter recv() noexcept { return recv_awaiter{*this}; }
+
+        // Any thread. Blocked senders resume with false; the receiver drains what is queued.
+        // A send racing close() may still land; the receiver sees it before end-of-stream.
+        void close()
+        {
+            // Senders claim through tail_, so no slot can be claimed past this position
+            const std::uint64_t end = tail_.fetch_or(CLOSED_BIT, std::memory_order_acq_rel) & ~CLOSED_BIT;
+            notifyReceiver(end);
+
+            std::lock_guard lock(senders_mutex_);
+            for (send_awaiter *sender : senders_)
+            {
+                sender->waiter_.wake();
+            }
+            senders_.clear();
+            blocked_senders_.store(0, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool closed() const noexcept
+        {
+            return (tail_.load(std::memory_order_acquire) & CLOSED_BIT) != 0;
+        }
+        [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    private:
+        struct slot
+        {
+            std::atomic<std::uint64_t> sequence{0};
+            std::optional<T> value;
+        };
+
+        // Closing sets this bit in tail_; positions stay far below it
+        static constexpr std::uint64_t CLOSED_BIT = std::uint64_t{1} << 63;
+
+        // Fails when full or closed; pos is the claimed position
+        bool enqueue(T &value, std::uint64_t &pos)
+        {
+            pos = tail_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                if ((pos & CLOSED_BIT) != 0)
+                {
+                    return false;
+                }
+                slot &s = slots_[pos & mask_];
+                const std::uint64_t sequence = s.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::int64_t>(sequence - pos);
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        s.value.emplace(std::move(value));
+                        s.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Receiver only: the next slot is written
+        [[nodiscard]] bool published() const noexcept
+        {
+            const std::uint64_t head = head_.load(std::memory_order_relaxed);
+            return slots_[head & mask_].sequence.load(std::memory_order_acquire) == head + 1;
+        }
+
+        // Receiver only: closed, and every slot claimed before that has been received
+        [[nodiscard]] bool drained() const noexcept
+        {
+            return tail_.load(std::memory_order_acquire) == (head_.load(std::memory_order_relaxed) | CLOSED_BIT);
+        }
+
+        // pos was just published (or is the close position). Only the slot the receiver
+        // waits on wakes it, so it never resumes to find that slot still being written.
+        void notifyReceiver(std::uint64_t pos)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (receiver_waiting_.load(std::memory_order_acquire) &&
+                head_.load(std::memory_order_relaxed) == pos &&
+                receiver_waiting_.exchange(false, std::memory_order_acq_rel))
+            {
+                receiver_.wake();
+            }
+        }
+
+        // Receiver only: hand freed slots to queued senders in arrival order
+        void admitSenders()
+        {
+            std::lock_guard lock(senders_mutex_);
+            std::uint64_t pos = 0;
+            while (!senders_.empty() && enqueue(senders_.front()->value_, pos))
+            {
+                send_awaiter *sender = senders_.front();
+                senders_.pop_front();
+                blocked_senders_.fetch_sub(1, std::memory_order_relaxed);
+                sender->sent_ = true;
+                sender->waiter_.wake();
+            }
+        }
+
+        const std::size_t capacity_;
+        const std::size_t mask_;
+        std::unique_ptr<slot[]> slots_;
+
+        // Claim position, plus CLOSED_BIT once closed
+        alignas(64) std::atomic<std::uint64_t> tail_{0};
+        // Written by the receiver only; senders read it to see which slot it waits on
+        alignas(64) std::atomic<std::uint64_t> head_{0};
+        detail::worker_waiter receiver_;
+        std::atomic<bool> receiver_waiting_{false};
+
+        alignas(64) std::atomic<std::size_t> blocked_senders_{0};
+        std::mutex senders_mutex_;
+        std::deque<send_awaiter *> senders_;
+    };
+
+} // namespace co_uring
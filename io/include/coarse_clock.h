@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace co_uring
+{
+
+    // Per-worker clock read once per event-loop pass. Heartbeats, session expiry and log
+    // timestamps on a worker only need to know roughly when the current batch of
+    // completions arrived, so they read the cached value instead of calling clock_gettime
+    // per packet. The log timestamp text is rendered from it on first use, at most once
+    // per millisecond, so passes that format no line (the async logger formats on its
+    // writer thread) never pay for it. The cached time
+    // is at most one pass old: a coroutine that runs for long without returning to the
+    // loop sees it go stale. Code that needs exact time (tick scheduling, latency
+    // measurement) uses precise().
+    //
+    // On threads without an event loop (main, compute pool, log writer) nothing refreshes
+    // the clock, so now() and friends fall through to the precise clocks.
+    class CoarseClock
+    {
+    public:
+        // "YYYY-mm-dd HH:MM:SS.mmm", as binlog::formatTimestamp writes it
+        static constexpr std::size_t TIMESTAMP_LENGTH = 23;
+
+        // Thread-local instance, like IoUring and Scheduler
+        static CoarseClock &getInstance() noexcept;
+
+        CoarseClock(const CoarseClock &) = delete;
+        CoarseClock &operator=(const CoarseClock &) = delete;
+
+        // Called by IoUring::eventLoop after every wait; the first call makes the clock active
+        void refresh() noexcept;
+
+        [[nodiscard]] bool isActive() const noexcept { return active_; }
+
+        [[nodiscard]] std::chrono::steady_clock::time_point now() const noexcept
+        {
+            return active_ ? steady_ : precise();
+        }
+
+        // Wall-clock nanoseconds since the epoch, as used for log timestamps
+        [[nodiscard]] std::int64_t unixNanos() const noexcept { return active_ ? unix_ns_ : preciseUnixNanos(); }
+
+        // unixNanos() rendered as local time, formatted on the first call after the
+        // millisecond changes; valid until the next refresh()
+        [[nodiscard]] std::string_view timestamp() noexcept;
+
+        static std::chrono::steady_clock::time_point precise() noexcept { return std::chrono::steady_clock::now(); }
+        static std::int64_t preciseUnixNanos() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+    private:
+        CoarseClock() = default;
+
+        bool active_ = false;
+        std::chrono::steady_clock::time_point steady_{};
+        std::int64_t unix_ns_ = 0;
+        // Millisecond timestamp_ was rendered for, -1 before the first render
+        std::int64_t rendered_ms_ = -1;
+        char timestamp_[TIMESTAMP_LENGTH + 1] = {};
+    };
+
+} // namespace co_uring
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "mailbox.h"
+#include "../../coroutine/include/chase_lev_deque.h"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace co_uring
+{
+
+    // Unit of work for the pool; offload() embeds one in its awaiter, so no allocation per job
+    struct compute_job
+    {
+        void (*run)(compute_job *job) = nullptr;
+    };
+
+    struct ComputePoolStats
+    {
+        std::size_t threads = 0;
+        std::uint64_t executed = 0;
+        // Jobs taken from another pool thread's deque
+        std::uint64_t stolen = 0;
+        // Jobs submitted from outside the pool (I/O workers)
+        std::uint64_t injected = 0;
+    };
+
+    // Process-wide work-stealing pool for CPU-heavy handler work, kept off the I/O workers.
+    // Each pool thread owns a Chase-Lev deque; jobs submitted from I/O workers go through a
+    // shared injection queue, and idle threads steal from each other's deques.
+    class ComputePool
+    {
+    public:
+        static ComputePool &getInstance() noexcept;
+
+        ComputePool(const ComputePool &) = delete;
+        ComputePool &operator=(const ComputePool &) = delete;
+
+        // Start thread_count pool threads; false if already running
+        bool start(std::size_t thread_count);
+        // Join the pool threads; jobs not started by then are dropped
+        void stop();
+
+        [[nodiscard]] bool isRunning() const noexcept { return running_.load(std::memory_order_acquire); }
+        [[nodiscard]] std::size_t threadCount() const noexcept { return threads_.size(); }
+
+        // Callable from any thread; jobs submitted by pool threads go on their own deque
+        void submit(compute_job *job);
+
+        // Resume handle on worker_index's event loop through its Mailbox (a MSG_RING CQE,
+        // sent and confirmed synchronously since pool threads have no loop to reap failures)
+        static void resumeOn(std::size_t worker_index, std::coroutine_handle<> handle);
+
+        [[nodiscard]] ComputePoolStats getStats() const noexcept;
+        void logStats() const;
+
+    private:
+        ComputePool() = default;
+        ~ComputePool();
+
+        struct alignas(64) pool_thread
+        {
+            chase_lev_deque<compute_job> deque;
+            std::atomic<std::uint64_t> executed{0};
+            std::atomic<std::uint64_t> stolen{0};
+            std::thread thread;
+        };
+
+        void run(std::size_t index);
+        compute_job *findWork(std::size_t index);
+        compute_job *takeInjected(std::size_t index);
+        void wakeOne();
+
+        std::vector<std::unique_ptr<pool_thread>> threads_;
+        std::atomic<bool> running_{false};
+
+        std::mutex inject_mutex_;
+        std::deque<compute_job *> injected_;
+        std::atomic<std::size_t> injected_size_{0};
+        std::atomic<std::uint64_t> injected_total_{0};
+
+        // Bumped on every submit; idle threads sleep on it with atomic wait
+        std::atomic<std::uint32_t> epoch_{0};
+        std::atomic<std::uint32_t> sleepers_{0};
+    };
+
+    // co_await offload(fn) runs fn on the compute pool and resumes the coroutine on the
+    // worker it came from, with fn's result or exception. Runs fn inline when the pool is
+    // not running or the caller is not on a worker (no ring to come back to).
+    template <typename Fn>
+    class offload_awaiter : compute_job
+    {
+    public:
+        using result_type = std::invoke_result_t<Fn &>;
+
+        explicit offload_awaiter(Fn fn) : fn_(std::move(fn)) {}
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            worker_ = Mailbox::currentWorker();
+            if (worker_ == Mailbox::NO_WORKER || !ComputePool::getInstance().isRunning())
+            {
+                invoke();
+                return false;
+            }
+
+            handle_ = handle;
+            run = &offload_awaiter::execute;
+            ComputePool::getInstance().submit(this);
+            return true;
+        }
+
+        result_type await_resume()
+        {
+            if (exception_)
+            {
+                std::rethrow_exception(exception_);
+            }
+            if constexpr (!std::is_void_v<result_type>)
+            {
+                return std::move(*result_);
+            }
+        }
+
+    private:
+        static void execute(compute_job *job)
+        {
+            auto *self = static_cast<offload_awaiter *>(job);
+            self->invoke();
+            // The coroutine may resume and destroy the awaiter as soon as it is posted
+            const std::size_t worker = self->worker_;
+            const std::coroutine_handle<> handle = self->handle_;
+            ComputePool::resumeOn(worker, handle);
+        }
+
+        void invoke() noexcept
+        {
+            try
+            {
+                if constexpr (std::is_void_v<result_type>)
+                {
+                    fn_();
+                }
+                else
+                {
+                    result_.emplace(fn_());
+                }
+            }
+            catch (...)
+            {
+                exception_ = std::current_exception();
+            }
+        }
+
+        struct no_result
+        {
+        };
+
+        Fn fn_;
+        std::optional<std::conditional_t<std::is_void_v<result_type>, no_result, result_type>> result_;
+        std::exception_ptr exception_;
+        std::coroutine_handle<> handle_;
+        std::size_t worker_ = Mailbox::NO_WORKER;
+    };
+
+    template <typename Fn>
+    auto offload(Fn &&fn)
+    {
+        return offload_awaiter<std::decay_t<Fn>>(std::forward<Fn>(fn));
+    }
+
+} // namespace co_uring
@@ -3,10 +3,13 @@
 #include <liburing.h>
 #include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <cerrno>
+#include <deque>
+#include <functional>
 #include <span>
 
 namespace co_uring
@@ -18,47 +21,170 @@ namespace co_uring
         void *coroutine = nullptr;
         std::int32_t cqe_res = 0;
         std::uint32_t cqe_flags = 0;
+        // Completion hook for multishot/multi-CQE operations; called instead of resuming `coroutine`
+        void (*on_complete)(sqe_data *) = nullptr;
+        void *context = nullptr;
+    };
+
+    // Task-run setup profiles. Each worker owns its ring on one thread, which is exactly
+    // the kernel's single-issuer model.
+    enum class SetupProfile
+    {
+        // No task-run flags
+        DEFAULT,
+        // SINGLE_ISSUER | COOP_TASKRUN | TASKRUN_FLAG: no IPI to interrupt the worker for task work
+        COOP_TASKRUN,
+        // SINGLE_ISSUER | DEFER_TASKRUN: task work runs only when the loop waits for events,
+        // falls back to COOP_TASKRUN on kernels before 6.1
+        DEFER_TASKRUN
+    };
+
+    // Ring setup options, chosen per worker before queueInit()
+    struct IoUringOptions
+    {
+        // Kernel-side submission polling (IORING_SETUP_SQPOLL)
+        bool sqpoll = false;
+        // Poller thread goes to sleep after this many idle milliseconds
+        std::uint32_t sqpoll_idle_ms = 2000;
+        // CPU the poller thread is pinned to, -1 leaves it unpinned
+        int sqpoll_cpu = -1;
+        // Ring fd whose poller/io-wq backend should be shared (IORING_SETUP_ATTACH_WQ), -1 for none
+        int attach_wq_fd = -1;
+        // Ignored with SQPOLL, which the kernel does not combine with task-run flags
+        SetupProfile profile = SetupProfile::DEFAULT;
+        // Max CQEs reaped per event-loop iteration before submitting again
+        std::uint32_t cqe_budget = 1024;
+    };
+
+    // SQ pressure counters, per worker
+    struct IoUringStats
+    {
+        // io_uring_submit calls forced by a full SQ
+        std::uint64_t early_submits = 0;
+        // Early submits after which the SQ was still full (SQPOLL lagging, submit failed)
+        std::uint64_t still_full = 0;
+        // Requests parked in the pending queue / later prepared from it
+        std::uint64_t deferred = 0;
+        std::uint64_t retried = 0;
+        // Largest pending queue length seen
+        std::uint64_t deferred_peak = 0;
+        // CQEs dispatched by the event loop
+        std::uint64_t completions = 0;
     };
 
     class IoUring
     {
     public:
-        static constexpr std::uint32_t IO_URING_QUEUE_SIZE = 4096;
-        static constexpr std::uint32_t BUF_RING_SIZE = 1024;
-        static constexpr std::uint32_t BUF_SIZE = 8192;
-        static constexpr std::uint32_t BUF_GROUP_ID = 1;
+        // SQ sized for steady state; bursts spill into the pending queue instead of failing
+        static constexpr std::uint32_t IO_URING_QUEUE_SIZE = 1024;
+        static constexpr std::uint32_t CQ_SIZE = 4096;
+        // CQEs copied out per io_uring_cq_advance
+        static constexpr std::uint32_t CQE_BATCH_SIZE = 256;
+        // Provided-buffer group recvs use unless told otherwise (see BufferRing::SIZE_CLASSES)
+        static constexpr std::uint16_t BUF_GROUP_ID = 2;
+        static constexpr std::uint32_t FIXED_FILE_TABLE_SIZE = 16384;
+        // Registered buffer slots; each pool registers a handful of large regions
+        static constexpr std::uint32_t FIXED_BUFFER_TABLE_SIZE = 16;
+        // Provided-buffer ring flag and CQE flag for incremental consumption (6.12+). Defined
+        // here because older uapi headers lack them and newer ones declare the flag as an enum.
+        static constexpr std::uint16_t PBUF_RING_INC = 2;
+        static constexpr std::uint32_t CQE_F_BUF_MORE = 1U << 4;
+        // Recv bundles (6.10+): one CQE covers a run of consecutive buffers from the ring
+        static constexpr std::uint16_t RECVSEND_BUNDLE = 1U << 4;
+        static constexpr std::uint32_t FEAT_RECVSEND_BUNDLE = 1U << 14;
 
         static IoUring &getInstance();
 
         ~IoUring();
 
-        int queueInit();
+        int queueInit(const IoUringOptions &options = {});
+
+        [[nodiscard]] int getRingFd() const noexcept { return io_uring_.ring_fd; }
+        [[nodiscard]] bool isSqPoll() const noexcept { return sqpoll_; }
+        [[nodiscard]] bool isInitialized() const noexcept { return initialized_; }
+        // Flags the ring was actually created with, after fallbacks
+        [[nodiscard]] bool hasSetupFlag(std::uint32_t flag) const noexcept { return (setup_flags_ & flag) != 0; }
+        // IORING_FEAT_* bits reported by the kernel at setup
+        [[nodiscard]] bool hasFeature(std::uint32_t feature) const noexcept { return (features_ & feature) != 0; }
+        [[nodiscard]] const IoUringStats &getStats() const noexcept { return stats_; }
+        [[nodiscard]] std::size_t pendingSqeCount() const noexcept { return pending_sqes_.size(); }
 
         void eventLoop();
 
+        // Ask eventLoop() to return after the current iteration; call from the loop thread
+        void stop() noexcept { running_ = false; }
+        // True while eventLoop() runs on this thread, i.e. queued SQEs will be submitted soon
+        [[nodiscard]] bool isRunning() const noexcept { return running_; }
+
+        // Submit queued SQEs without waiting, for threads that do not run eventLoop()
+        int submit();
+
         int registerBufRing();
 
-        // Setup buffer ring with provided buffer ring pointer and buffer list
-        int setupBufRing(io_uring_buf_ring *buf_ring,
-                         const std::vector<std::vector<std::uint_least8_t>> &buf_list) noexcept;
+        // Register an empty fixed-file table for direct descriptors
+        int registerSparseFiles(std::uint32_t count = FIXED_FILE_TABLE_SIZE);
 
+        // Register buffers for IORING_RECVSEND_FIXED_BUF; the kernel pins them once here.
+        // Returns the buffer index of the first one, or a negative errno.
+        int registerBuffers(std::span<const iovec> buffers);
+        void unregisterBuffers(std::uint32_t first_index, std::uint32_t count);
+
+        // Initialise and register an empty provided-buffer ring as group_id; entries is a power of two.
+        // flags: PBUF_RING_INC, rejected with -EINVAL by kernels that lack it.
+        int setupBufRing(io_uring_buf_ring *buf_ring, std::uint16_t group_id, std::uint32_t entries,
+                         std::uint16_t flags = 0) noexcept;
+
+        // wait_nr == 0 submits without blocking
         int submitAndWait(std::uint32_t wait_nr);
 
+        // direct: accepted sockets land in the fixed-file table, cqe_res is the slot index
         void submitMultishotAcceptRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd,
-                                          sockaddr *client_addr, socklen_t *client_len);
+                                          sockaddr *client_addr, socklen_t *client_len,
+                                          bool direct = false);
+
+        // fixed: raw_fd is a fixed-file slot index (IOSQE_FIXED_FILE); buf_group picks the provided-buffer group
+        void submitRecvRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, bool fixed = false,
+                               std::uint16_t buf_group = BUF_GROUP_ID);
+
+        // One SQE, one CQE per received chunk while IORING_CQE_F_MORE is set.
+        // bundle: each CQE may span several buffers (needs FEAT_RECVSEND_BUNDLE)
+        void submitMultishotRecvRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, bool fixed = false,
+                                        std::uint16_t buf_group = BUF_GROUP_ID, bool bundle = false);
+
+        // buf_index >= 0: buf lies inside that registered buffer (IORING_RECVSEND_FIXED_BUF).
+        // Kernels before 6.10 reject fixed buffers on plain send with -EINVAL.
+        void submitSendRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, std::span<const std::uint8_t> buf,
+                               bool fixed = false, int buf_index = -1);
+
+        // Zero-copy send: posts the result CQE, then an IORING_CQE_F_NOTIF CQE once the kernel
+        // no longer references buf
+        void submitSendZcRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, std::span<const std::uint8_t> buf,
+                                 bool fixed = false, int buf_index = -1);
 
-        void submitRecvRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd);
+        void submitNopRequest(sqe_data *sqe_data_ptr);
 
-        void submitSendRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, std::span<const std::uint8_t> buf);
+        // IORING_OP_TIMEOUT; absolute deadlines are CLOCK_MONOTONIC. ts must stay valid until submitted.
+        void submitTimeoutRequest(sqe_data *sqe_data_ptr, __kernel_timespec *ts, bool absolute = false);
+
+        // Post a CQE carrying target_data into another ring (IORING_OP_MSG_RING).
+        // The local CQE is only posted on failure, to sqe_data_ptr.
+        void submitMsgRingRequest(sqe_data *sqe_data_ptr, int target_ring_fd, sqe_data *target_data);
+
+        // Close a direct descriptor slot; only failures post a CQE
+        void submitCloseDirectRequest(std::uint32_t file_index);
 
         void submitSpliceRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd_in,
                                  std::uint32_t raw_fd_out, std::uint32_t len);
 
         void submitCancelRequest(sqe_data *sqe_data_ptr);
+        // cancel_scope hook: targeted ASYNC_CANCEL of the request owning target (a sqe_data),
+        // on the calling worker's ring; the request then completes with -ECANCELED
+        static void cancelOperation(void *target) noexcept;
 
+        // Hand one buffer back to a ring of ring_entries slots
         void addBuf(io_uring_buf_ring *buf_ring,
                     std::uint8_t *buf, std::size_t buf_size,
-                    std::uint32_t buf_id);
+                    std::uint32_t buf_id, std::uint32_t ring_entries);
 
     private:
         IoUring() = default;
@@ -69,7 +195,39 @@ namespace co_uring
         int decode(int result);
         void unwrap(int result);
 
+        // CQE fields copied out of the ring so slots can be released before resuming
+        struct completion
+        {
+            sqe_data *data;
+            std::int32_t res;
+            std::uint32_t flags;
+        };
+
+        std::uint32_t reapCompletions(completion *out, std::uint32_t max_count);
+        void dispatchCompletion(const completion &entry);
+
+        // Poller thread went idle and needs IORING_ENTER_SQ_WAKEUP
+        [[nodiscard]] bool sqNeedsWakeup() const noexcept;
+
+        // SQE for a new request, submitting early once if the SQ is full; nullptr means defer
+        io_uring_sqe *acquireSqe();
+        // Fill an SQE now, or queue the preparation until the SQ drains
+        template <typename Prep>
+        void prepare(Prep &&prep);
+        // Prepare deferred requests in order while SQEs are available
+        void flushPendingSqes();
+
         io_uring io_uring_;
+        bool initialized_ = false;
+        std::uint32_t setup_flags_ = 0;
+        std::uint32_t features_ = 0;
+        bool sqpoll_ = false;
+        bool running_ = false;
+        bool fixed_buffer_table_ = false;
+        std::uint32_t fixed_buffer_slots_used_ = 0;
+        std::uint32_t cqe_budget_ = 1024;
+        std::deque<std::function<void(io_uring_sqe *)>> pending_sqes_;
+        IoUringStats stats_;
     };
 
 } // namespace co_uring
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "logger.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace co_uring
+{
+
+    // What a thread does when its log ring is full
+    enum class LogOverflow
+    {
+        DROP,  // discard the record and count it; the caller never waits
+        BLOCK, // wait for the writer to make room (stalls the calling worker)
+    };
+
+    enum class LogFormat
+    {
+        TEXT,   // rendered lines, as the synchronous logger writes
+        BINARY, // binlog records; read back with tools/logdecode
+    };
+
+    struct LogBackendOptions
+    {
+        // Empty: console only
+        std::string path;
+        LogFormat format = LogFormat::TEXT;
+        bool console = true;
+        bool color = true;
+        // Records per thread ring, rounded up to a power of two
+        std::size_t ring_records = 1024;
+        LogOverflow overflow = LogOverflow::DROP;
+        // Rotate once the file reaches this size (0: never)
+        std::size_t rotate_bytes = 64 * 1024 * 1024;
+        // Rotate after this long (0: never)
+        std::chrono::seconds rotate_interval{0};
+        // Longest a record waits in a ring before the writer picks it up
+        std::chrono::milliseconds flush_interval{10};
+    };
+
+    struct LogBackendStats
+    {
+        std::uint64_t written = 0;
+        std::uint64_t dropped = 0;
+        // Times a producer found its ring full under LogOverflow::BLOCK
+        std::uint64_t blocked = 0;
+        // Messages cut to fit a record
+        std::uint64_t truncated = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t rotations = 0;
+        std::uint64_t write_errors = 0;
+    };
+
+    // One log call, rendered to text only on the writer thread. file and func point at
+    // string literals (__FILE__, __FUNCTION__), so only the message is copied. A binary
+    // record carries a log_site id and the encoded arguments instead of a message.
+    struct log_record
+    {
+        static constexpr std::size_t SIZE = 256;
+
+        // system_clock nanoseconds since epoch; binlog::ticks() for binary records
+        std::int64_t timestamp = 0;
+        const char *file = "";
+        const char *func = "";
+        std::int32_t line = 0;
+        // Binary records: the log_site id; 0 for text
+        std::uint32_t site = 0;
+        LogLevel level = LogLevel::INFO;
+        std::uint16_t length = 0;
+        char text[SIZE - 40];
+    };
+    static_assert(sizeof(log_record) == log_record::SIZE);
+    static_assert(sizeof(log_record::text) == binlog::MAX_PAYLOAD);
+
+    // Asynchronous sink behind Logger. Every thread that logs gets its own single-producer
+    // ring of fixed-size records, so a log call is a copy into memory the thread owns and
+    // one release store: no lock, no syscall, no formatting of the prefix. A dedicated
+    // writer thread drains the rings, renders a batch of lines, and appends it to the file
+    // through its own io_uring while it renders the next batch, rotating by size or age.
+    class LogBackend
+    {
+    public:
+        static LogBackend &getInstance() noexcept;
+
+        LogBackend(const LogBackend &) = delete;
+        LogBackend &operator=(const LogBackend &) = delete;
+
+        // Open the file and start the writer; false if already running or the file cannot be opened
+        bool start(LogBackendOptions options);
+        // Drain every ring, flush and join the writer. Records pushed after this are lost,
+        // so stop once the workers have stopped logging.
+        void stop();
+
+        [[nodiscard]] bool isRunning() const noexcept { return running_.load(std::memory_order_acquire); }
+
+        // Any thread; file and func must outlive the backend (string literals). Returns false
+        // if this thread can no longer queue (it is exiting); the caller then writes directly.
+        bool push(LogLevel level, const char *file, int line, const char *func, std::string_view message);
+
+        // Binary format: assigns site its id and queues its descriptor for the file
+        std::uint32_t registerSite(log_site &site, std::string_view types);
+        // Binary format: queues one call's encoded arguments; false when not running in
+        // binary format or this thread can no longer queue
+        bool pushBinary(const log_site &site, const binlog::payload_writer &payload);
+
+        [[nodiscard]] LogBackendStats getStats() const noexcept;
+
+        // Fills the record header with the current time; the text is left alone
+        static void stamp(log_record &record, LogLevel level, const char *file, int line, const char *func) noexcept;
+        // Appends one rendered line (with the trailing newline) to out. Also used by Logger's
+        // synchronous path, so both produce the same format.
+        static void render(std::string &out, const log_record &record, std::string_view message,
+                           std::string_view thread, bool color);
+        // Short id of the calling thread, computed once per thread
+        static std::string_view threadTag();
+
+    private:
+        LogBackend() = default;
+        ~LogBackend();
+
+        struct log_ring;
+        class file_writer;
+
+        log_ring *ringForThread();
+        // Next free record in the calling thread's ring, applying the overflow policy;
+        // nullptr if the record is dropped. publish() makes it visible to the writer.
+        log_record *claim(log_ring *ring);
+        void publish(log_ring *ring);
+        void wakeWriter();
+        void run();
+        bool drain(std::string &file_batch, std::string &console_batch);
+        void appendBinary(std::string &out, const log_record &record, std::string_view thread);
+        void renderBinary(std::string &out, const log_record &record, std::string_view thread);
+
+        LogBackendOptions options_;
+        std::atomic<bool> running_{false};
+        std::thread writer_;
+        std::unique_ptr<file_writer> file_;
+
+        // Registered rings; a thread keeps its own alive until it exits
+        std::mutex rings_mutex_;
+        std::vector<std::shared_ptr<log_ring>> rings_;
+        // Bumped on every start, so threads re-register after a restart
+        std::atomic<std::uint64_t> generation_{0};
+
+        std::mutex wake_mutex_;
+        std::condition_variable wake_cv_;
+        bool wake_requested_ = false;
+        std::atomic<bool> writer_sleeping_{false};
+
+        std::atomic<std::uint64_t> written_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<std::uint64_t> blocked_{0};
+        std::atomic<std::uint64_t> truncated_{0};
+        std::atomic<std::uint64_t> bytes_{0};
+        std::atomic<std::uint64_t> rotations_{0};
+        std::atomic<std::uint64_t> write_errors_{0};
+        // Writer only: drops already reported in the log itself
+        std::uint64_t reported_dropped_ = 0;
+
+        // Binary format: every registered site, by id - 1
+        std::mutex sites_mutex_;
+        std::vector<binlog::descriptor> sites_;
+        binlog::clock_sync clock_;
+        // Writer only: whether the current file still needs its header, descriptors already
+        // in it, the writer's copy of sites_, events held back until their descriptors are
+        // written, and the time of the last clock record
+        bool header_pending_ = false;
+        std::size_t sites_written_ = 0;
+        std::vector<binlog::descriptor> writer_sites_;
+        std::string events_;
+        std::chrono::steady_clock::time_point last_sync_;
+    };
+
+} // namespace co_uring
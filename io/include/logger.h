@@ -1,15 +1,24 @@
 #pragma once
 
+#include "binary_log.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <iomanip>
 
+// Calls below this level compile to nothing: 0 DEBUG, 1 INFO, 2 WARN, 3 ERROR.
+// Release builds can pass -DCO_URING_LOG_MIN_LEVEL=1 to strip every LOG_DEBUG.
+#ifndef CO_URING_LOG_MIN_LEVEL
+#define CO_URING_LOG_MIN_LEVEL 0
+#endif
+
 namespace co_uring
 {
 
@@ -21,46 +30,78 @@ namespace co_uring
         ERROR = 3
     };
 
+    // One LOG_* call site, a constant-initialised static in the macro expansion. In binary
+    // mode it is registered with LogBackend on first use and each call writes only its id.
+    struct log_site
+    {
+        LogLevel level;
+        const char *format;
+        const char *file;
+        int line;
+        const char *func;
+        // 0 until registered
+        std::atomic<std::uint32_t> id{0};
+    };
+
     class Logger
     {
     public:
         static Logger &getInstance();
 
-        void setLogLevel(LogLevel level) { logLevel_ = level; }
+        void setLogLevel(LogLevel level) { logLevel_.store(level, std::memory_order_relaxed); }
         void setLogFile(const std::string &filename);
         void setConsoleOutput(bool enabled) { consoleOutput_ = enabled; }
         void setColorOutput(bool enabled) { colorOutput_ = enabled; }
 
-        void logMessage(LogLevel level, const std::string &file, int line, const std::string &func, const std::string &message);
+        // The runtime filter the LOG_* macros check before touching their arguments:
+        // one relaxed load and a compare, no call into the logger
+        static bool isEnabled(LogLevel level) noexcept
+        {
+            return level >= logLevel_.load(std::memory_order_relaxed);
+        }
+
+        // file and func must be string literals: the async backend keeps the pointers
+        void logMessage(LogLevel level, const char *file, int line, const char *func, std::string_view message);
 
+        // Binary mode: on while LogBackend runs with LogFormat::BINARY
+        static void setBinaryOutput(bool enabled) noexcept { binary_.store(enabled, std::memory_order_relaxed); }
+
+        // Callers have already checked isEnabled. In binary mode the arguments are copied
+        // raw and formatted later by the decoder; otherwise they are formatted here.
         template <typename... Args>
-        void log(LogLevel level, const std::string &file, int line, const std::string &func, const std::string &format, Args &&...args)
+        void log(log_site &site, Args &&...args)
         {
-            if (level < logLevel_)
-                return;
+            if (binary_.load(std::memory_order_relaxed))
+            {
+                binlog::payload_writer payload;
+                (payload.add(args), ...);
+                if (writeBinary(site, binlog::type_codes<Args...>::value, payload))
+                {
+                    return;
+                }
+            }
 
             std::ostringstream oss;
-            formatHelper(oss, format, std::forward<Args>(args)...);
-            logMessage(level, file, line, func, oss.str());
+            formatHelper(oss, site.format, std::forward<Args>(args)...);
+            writeLog(site.level, site.file, site.line, site.func, oss.str());
         }
 
     private:
         Logger() = default;
         ~Logger();
 
-        void writeLog(LogLevel level, const std::string &file, int line, const std::string &func, const std::string &message);
-        std::string getCurrentTime();
-        std::string getThreadId();
-        std::string getLevelString(LogLevel level);
-        std::string getColorCode(LogLevel level);
+        // Hands the line to LogBackend when it is running, otherwise writes it here
+        void writeLog(LogLevel level, const char *file, int line, const char *func, std::string_view message);
+        // False if the backend cannot take binary records now; the caller formats instead
+        bool writeBinary(log_site &site, std::string_view types, const binlog::payload_writer &payload);
 
-        void formatHelper(std::ostringstream &oss, const std::string &format)
+        void formatHelper(std::ostringstream &oss, std::string_view format)
         {
             oss << format;
         }
 
         template <typename T, typename... Args>
-        void formatHelper(std::ostringstream &oss, const std::string &format, T &&value, Args &&...args)
+        void formatHelper(std::ostringstream &oss, std::string_view format, T &&value, Args &&...args)
         {
             size_t pos = format.find("{}");
             if (pos != std::string::npos)
@@ -70,27 +111,39 @@ namespace co_uring
             }
             else
             {
-                oss << format;
-                if (sizeof...(args) > 0)
-                {
-                    oss << " ";
-                    ((oss << args << " "), ...);
-                }
+                // More arguments than {}: append the rest, as the binary decoder does
+                oss << format << " " << value;
+                ((oss << " " << args), ...);
             }
         }
 
-        LogLevel logLevel_ = LogLevel::INFO;
+        inline static std::atomic<LogLevel> logLevel_{LogLevel::INFO};
+        inline static std::atomic<bool> binary_{false};
         bool consoleOutput_ = true;
         bool colorOutput_ = true;
         std::unique_ptr<std::ofstream> logFile_;
         std::mutex logMutex_;
     };
 
-// 매크로 정의
-#define LOG_DEBUG(...) co_uring::Logger::getInstance().log(co_uring::LogLevel::DEBUG, __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__)
-#define LOG_INFO(...) co_uring::Logger::getInstance().log(co_uring::LogLevel::INFO, __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__)
-#define LOG_WARN(...) co_uring::Logger::getInstance().log(co_uring::LogLevel::WARN, __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__)
-#define LOG_ERROR(...) co_uring::Logger::getInstance().log(co_uring::LogLevel::ERROR, __FILE__, __LINE__, __FUNCTION__, __VA_ARGS__)
+// 매크로 정의: 컴파일 타임 최소 레벨 아래는 코드가 생성되지 않고, 런타임에 걸러지는 호출은
+// 레벨 비교 한 번 뒤에만 인자를 평가하고 포맷함
+#define CO_URING_LOG(level_value, level, format, ...)                                                              \
+    do                                                                                                                \
+    {                                                                                                                 \
+        if constexpr ((level_value) >= CO_URING_LOG_MIN_LEVEL)                                                        \
+        {                                                                                                             \
+            if (co_uring::Logger::isEnabled(level)) [[unlikely]]                                                      \
+            {                                                                                                         \
+                static co_uring::log_site co_uring_log_site{level, format, __FILE__, __LINE__, __FUNCTION__};         \
+                co_uring::Logger::getInstance().log(co_uring_log_site __VA_OPT__(, ) __VA_ARGS__);                    \
+            }                                                                                                         \
+        }                                                                                                             \
+    } while (0)
+
+#define LOG_DEBUG(...) CO_URING_LOG(0, co_uring::LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) CO_URING_LOG(1, co_uring::LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) CO_URING_LOG(2, co_uring::LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) CO_URING_LOG(3, co_uring::LogLevel::ERROR, __VA_ARGS__)
 
 // 간단한 로깅 매크로
 #define SIMPLE_LOG_DEBUG(...) co_uring::Logger::getInstance().logMessage(co_uring::LogLevel::DEBUG, "", 0, "", __VA_ARGS__)
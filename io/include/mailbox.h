@@ -0,0 +1,89 @@
+#pragma once
+
+#include "io_uring.h"
+#include "../../coroutine/include/mpsc_queue.h"
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+
+namespace co_uring
+{
+
+    // Per-worker inbox for cross-worker messages. Producers push into a lock-free
+    // MPSC queue and wake the owner with IORING_OP_MSG_RING, which lands as a CQE
+    // in the owner's ring; the owner drains the queue from its event loop.
+    // No mutex, no eventfd, and no syscall on the owner side beyond its normal wait.
+    class Mailbox
+    {
+    public:
+        static constexpr std::size_t MAX_WORKERS = 64;
+        static constexpr std::size_t NO_WORKER = static_cast<std::size_t>(-1);
+
+        using message = std::function<void()>;
+
+        // Thread-local instance, like IoUring and BufferRing
+        static Mailbox &getInstance() noexcept;
+
+        // Owner of the worker slot, or nullptr if that worker is not running
+        static Mailbox *forWorker(std::size_t worker_index) noexcept;
+
+        // Worker index of the calling thread, NO_WORKER for non-worker threads
+        static std::size_t currentWorker() noexcept;
+
+        ~Mailbox();
+
+        Mailbox(const Mailbox &) = delete;
+        Mailbox &operator=(const Mailbox &) = delete;
+
+        // Register this thread's mailbox as worker_index; the thread's ring must be initialised
+        void attach(std::size_t worker_index) noexcept;
+        void detach() noexcept;
+
+        // Run fn on the target worker's thread. Callable from any thread; threads that do not
+        // run an event loop send the wakeup synchronously from a small private ring and block
+        // until it is delivered. Returns false if the target is not attached.
+        static bool post(std::size_t worker_index, message fn);
+
+        // Messages handled by this mailbox
+        [[nodiscard]] std::uint64_t getDeliveredCount() const noexcept { return delivered_; }
+
+    private:
+        Mailbox() noexcept;
+
+        // Wake the owner unless a wakeup is already in flight
+        void notify();
+        void drain();
+
+        static void on_wakeup(sqe_data *data);
+        static void on_send_failed(sqe_data *data);
+
+        mpsc_queue<message> queue_;
+        std::atomic<bool> wakeup_pending_{false};
+        sqe_data wakeup_data_;
+        int ring_fd_ = -1;
+        std::size_t worker_index_ = NO_WORKER;
+        std::uint64_t delivered_ = 0;
+
+        // Local failure CQEs of MSG_RING sends issued from this thread, one per target
+        std::array<sqe_data, MAX_WORKERS> send_data_;
+    };
+
+    // co_await switch_to_worker(i) resumes the coroutine on worker i's thread
+    class switch_to_worker
+    {
+    public:
+        explicit switch_to_worker(std::size_t worker_index) noexcept : worker_index_(worker_index) {}
+
+        [[nodiscard]] bool await_ready() const noexcept { return Mailbox::currentWorker() == worker_index_; }
+        bool await_suspend(std::coroutine_handle<> coroutine);
+        // false if the target worker was not running and the coroutine stayed where it was
+        [[nodiscard]] bool await_resume() const noexcept { return switched_; }
+
+    private:
+        std::size_t worker_index_;
+        bool switched_ = true;
+    };
+
+} // namespace co_uring
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace co_uring
+{
+
+    struct SchedulerStats
+    {
+        std::uint64_t scheduled = 0;
+        std::uint64_t resumed = 0;
+        // Event-loop passes that hit the budget with work still queued
+        std::uint64_t budget_exhausted = 0;
+        std::size_t peak_ready = 0;
+    };
+
+    // Per-worker ready queue. The event loop reaps CQEs, then resumes at most budget
+    // coroutines from here before going back to the ring, so a coroutine that never
+    // touches I/O can still hand the thread to other sessions with co_await yield().
+    // While the queue is non-empty the loop polls the ring instead of sleeping.
+    class Scheduler
+    {
+    public:
+        static constexpr std::uint32_t DEFAULT_BUDGET = 64;
+
+        // Thread-local instance, like IoUring and BufferRing; the worker owning the thread sets it up
+        static Scheduler &getInstance() noexcept;
+
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        // Resume handle from the event loop on a later pass instead of inline
+        void schedule(std::coroutine_handle<> handle);
+
+        // Resume up to the budget of coroutines queued before this call; ones they
+        // schedule wait for the next pass. Returns how many were resumed.
+        std::size_t runReady();
+
+        [[nodiscard]] bool hasReady() const noexcept { return !ready_.empty(); }
+        [[nodiscard]] std::size_t readyCount() const noexcept { return ready_.size(); }
+
+        void setBudget(std::uint32_t budget) noexcept { budget_ = budget > 0 ? budget : 1; }
+        [[nodiscard]] std::uint32_t budget() const noexcept { return budget_; }
+
+        [[nodiscard]] const SchedulerStats &getStats() const noexcept { return stats_; }
+        void logStats() const;
+
+    private:
+        Scheduler() = default;
+
+        std::deque<std::coroutine_handle<>> ready_;
+        std::uint32_t budget_ = DEFAULT_BUDGET;
+        SchedulerStats stats_;
+    };
+
+    // co_await yield() puts the coroutine at the back of this worker's ready queue
+    class yield
+    {
+    public:
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { Scheduler::getInstance().schedule(handle); }
+        void await_resume() const noexcept {}
+    };
+
+} // namespace co_uring
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace co_uring
+{
+
+    class SendBufferPool;
+
+    // Outbound packet buffer. Pooled buffers live inside a registered buffer and are sent
+    // with IORING_RECVSEND_FIXED_BUF; oversized requests or an exhausted class fall back to
+    // a heap block that is sent normally. Must be destroyed on the worker that acquired it.
+    class send_buffer
+    {
+    public:
+        send_buffer() noexcept = default;
+        ~send_buffer() noexcept;
+
+        send_buffer(const send_buffer &) = delete;
+        send_buffer &operator=(const send_buffer &) = delete;
+        send_buffer(send_buffer &&other) noexcept;
+        send_buffer &operator=(send_buffer &&other) noexcept;
+
+        [[nodiscard]] std::uint8_t *data() noexcept { return data_; }
+        [[nodiscard]] const std::uint8_t *data() const noexcept { return data_; }
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+        explicit operator bool() const noexcept { return data_ != nullptr; }
+
+        // Bytes to send; clamped to capacity
+        void resize(std::size_t size) noexcept;
+        // Copy bytes to the end, returns false if they do not fit
+        bool append(std::span<const std::uint8_t> bytes) noexcept;
+
+        [[nodiscard]] std::span<const std::uint8_t> span() const noexcept { return {data_, size_}; }
+
+        // Registered buffer index for fixed sends, -1 for heap fallback buffers
+        [[nodiscard]] int buf_index() const noexcept { return buf_index_; }
+
+    private:
+        friend class SendBufferPool;
+
+        void release() noexcept;
+
+        std::uint8_t *data_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t capacity_ = 0;
+        int buf_index_ = -1;
+        std::uint32_t class_index_ = 0;
+        std::uint32_t slot_ = 0;
+        SendBufferPool *pool_ = nullptr;
+        std::unique_ptr<std::uint8_t[]> heap_;
+    };
+
+    struct SendBufferClassStats
+    {
+        std::size_t slot_size = 0;
+        std::size_t slot_count = 0;
+        std::size_t in_use = 0;
+        std::size_t peak_in_use = 0;
+        std::uint64_t acquired = 0;
+        // Requests for this class that found it empty and went to the heap
+        std::uint64_t exhausted = 0;
+    };
+
+    // Per-worker slab allocator for outbound buffers. Each size class is one mmap'd arena
+    // registered as one io_uring fixed buffer, so a send never pins pages per call.
+    class SendBufferPool
+    {
+    public:
+        struct size_class
+        {
+            std::size_t slot_size;
+            std::size_t slot_count;
+        };
+
+        // ~3 MiB per worker; registered memory counts against RLIMIT_MEMLOCK
+        static constexpr std::array<size_class, 5> SIZE_CLASSES{{
+            {256, 512},
+            {1024, 512},
+            {4096, 256},
+            {16384, 64},
+            {65536, 8},
+        }};
+
+        static SendBufferPool &getInstance() noexcept
+        {
+            thread_local SendBufferPool instance;
+            return instance;
+        }
+
+        ~SendBufferPool();
+
+        SendBufferPool(const SendBufferPool &) = delete;
+        SendBufferPool &operator=(const SendBufferPool &) = delete;
+
+        // Map the arenas and register them with this thread's ring (initialise the ring first).
+        // If registration fails the pool still works, with buffers sent as regular memory.
+        int init();
+
+        // Buffer with capacity >= size and size() == size
+        [[nodiscard]] send_buffer acquire(std::size_t size);
+
+        // Copy bytes into a new buffer
+        [[nodiscard]] send_buffer copy(std::span<const std::uint8_t> bytes);
+
+        [[nodiscard]] bool isInitialized() const noexcept { return initialized_; }
+        [[nodiscard]] bool isRegistered() const noexcept { return registered_; }
+        [[nodiscard]] SendBufferClassStats classStats(std::size_t class_index) const noexcept;
+        // Requests larger than the biggest class
+        [[nodiscard]] std::uint64_t oversizedCount() const noexcept { return oversized_; }
+
+    private:
+        SendBufferPool() = default;
+
+        friend class send_buffer;
+        void release(send_buffer &buffer) noexcept;
+
+        struct arena
+        {
+            std::uint8_t *base = nullptr;
+            std::size_t length = 0;
+            std::vector<std::uint32_t> free_slots;
+            SendBufferClassStats stats;
+        };
+
+        std::array<arena, SIZE_CLASSES.size()> arenas_;
+        std::uint64_t oversized_ = 0;
+        // Registered buffer index of the first size class
+        int buf_index_base_ = -1;
+        bool initialized_ = false;
+        bool registered_ = false;
+    };
+
+} // namespace co_uring
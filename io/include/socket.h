@@ -6,12 +6,15 @@
 #include <coroutine>
 #include <memory>
 #include <optional>
+#include <deque>
 #include <tuple>
 #include <cstdint>
 #include <cstddef>
 #include <liburing.h>
+#include "../../coroutine/include/cancel_scope.h"
 #include "../../coroutine/include/task.h"
 #include "io_uring.h"
+#include "send_buffer_pool.h"
 #include <span>
 
 namespace co_uring
@@ -19,47 +22,217 @@ namespace co_uring
 
     class sqe_data;
 
+    // Tag selecting a fixed-file slot index instead of a regular descriptor
+    struct fixed_file_t
+    {
+        explicit fixed_file_t() = default;
+    };
+    inline constexpr fixed_file_t fixed_file{};
+
     class socket_client : public file
     {
     public:
         using file::file;
 
+        // Direct descriptor living in the worker's fixed-file table
+        socket_client(std::uint32_t file_index, fixed_file_t) noexcept;
+        ~socket_client() noexcept override;
+
+        [[nodiscard]] bool is_fixed() const noexcept { return fixed_; }
+
         class recv_awaiter
         {
         public:
-            recv_awaiter(std::uint32_t raw_fd) noexcept;
+            recv_awaiter(std::uint32_t raw_fd, bool fixed = false) noexcept;
 
             [[nodiscard]] bool await_ready() const noexcept;
-            void await_suspend(std::coroutine_handle<> coroutine) noexcept;
+
+            template <typename Promise>
+            void await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+            {
+                submit(coroutine);
+                scope_ = cancel_scope_of(coroutine);
+                if (scope_ != nullptr)
+                {
+                    scope_->bind(&IoUring::cancelOperation, &sqe_data_);
+                }
+            }
+
             [[nodiscard]] int await_resume() noexcept;
             [[nodiscard]] std::uint32_t get_buffer_id() const noexcept { return buffer_id_; }
+            // Where the data starts in the buffer; non-zero only with incremental buffer rings
+            [[nodiscard]] std::uint32_t get_buffer_offset() const noexcept { return buffer_offset_; }
             [[nodiscard]] std::uint32_t get_buffer_size() const noexcept { return buffer_size_; }
 
         private:
+            void submit(std::coroutine_handle<> coroutine) noexcept;
+
             mutable sqe_data sqe_data_;
+            cancel_scope *scope_ = nullptr;
             const std::uint32_t raw_fd_;
+            const bool fixed_;
             mutable std::uint32_t buffer_id_{0};
+            mutable std::uint32_t buffer_offset_{0};
             mutable std::uint32_t buffer_size_{0};
         };
 
         [[nodiscard]] recv_awaiter recv() const noexcept;
 
+        // Multishot recv: one SQE feeds a stream of provided-buffer chunks and re-arms itself
+        // when the kernel ends the multishot. Each chunk owns its slice until returnBuf().
+        // The buffer group follows the observed chunk sizes, and an empty group parks the
+        // recv until a buffer is returned instead of failing it.
+        class recv_stream
+        {
+        public:
+            struct chunk
+            {
+                // > 0 bytes received, 0 peer closed, < 0 error
+                std::int32_t result = 0;
+                std::uint32_t buffer_id = 0;
+                // Bytes are [offset, offset + length) of the buffer; see BufferRing::borrowSlice
+                std::uint32_t offset = 0;
+                std::uint32_t length = 0;
+                // Recv bundles span this many ring buffers from buffer_id; walk them with
+                // BufferRing::forEachSlice and release them with BufferRing::returnBufs
+                std::uint32_t buffer_count = 1;
+            };
+
+            recv_stream(std::uint32_t raw_fd, bool fixed) noexcept;
+            ~recv_stream() noexcept;
+
+            recv_stream(const recv_stream &) = delete;
+            recv_stream &operator=(const recv_stream &) = delete;
+            recv_stream(recv_stream &&) noexcept = default;
+            recv_stream &operator=(recv_stream &&) noexcept = delete;
+
+            class next_awaiter
+            {
+            public:
+                explicit next_awaiter(recv_stream &stream) noexcept : stream_(stream) {}
+
+                [[nodiscard]] bool await_ready() const noexcept;
+
+                // Cancelling the wait leaves the multishot armed: the coroutine resumes with
+                // -ECANCELED and anything that arrives stays queued for the next next()
+                template <typename Promise>
+                void await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+                {
+                    wait(coroutine);
+                    scope_ = cancel_scope_of(coroutine);
+                    if (scope_ != nullptr)
+                    {
+                        scope_->bind(&state::cancel_wait, stream_.state_.get());
+                    }
+                }
+
+                [[nodiscard]] chunk await_resume() noexcept;
+
+            private:
+                void wait(std::coroutine_handle<> coroutine) noexcept;
+
+                recv_stream &stream_;
+                cancel_scope *scope_ = nullptr;
+            };
+
+            // Next received chunk; only one coroutine may wait at a time
+            [[nodiscard]] next_awaiter next() noexcept { return next_awaiter{*this}; }
+
+            // BufferRing size class currently armed (or to be armed next)
+            [[nodiscard]] std::size_t buffer_class() const noexcept { return state_->class_index_; }
+
+        private:
+            struct state
+            {
+                sqe_data sqe_data_;
+                std::uint32_t raw_fd_;
+                bool fixed_;
+                bool armed_ = false;
+                bool finished_ = false;
+                bool detached_ = false;
+                // Waiting in BufferRing for a buffer of class_index_ to come back
+                bool parked_ = false;
+                // Cancelled to re-arm on target_class_
+                bool regrouping_ = false;
+                // The waiter's cancel scope fired; it resumes without a chunk
+                bool wait_cancelled_ = false;
+                std::size_t class_index_;
+                std::size_t target_class_ = 0;
+                // Moving average of chunk length, and chunks since the class last changed
+                std::uint32_t average_length_ = 0;
+                std::uint32_t chunks_since_switch_ = 0;
+                std::deque<chunk> ready_;
+                std::coroutine_handle<> waiter_;
+
+                void arm() noexcept;
+                void observe(std::uint32_t offset, std::uint32_t length) noexcept;
+                static void on_complete(sqe_data *data);
+                static void on_buffers_returned(void *context);
+                static void cancel_wait(void *target) noexcept;
+            };
+
+            // Heap state outlives the stream until the kernel posts the final CQE
+            std::unique_ptr<state> state_;
+        };
+
+        [[nodiscard]] recv_stream recv_multishot() const noexcept;
+
+        // Payloads at or above this size go through IORING_OP_SEND_ZC, 0 disables zero-copy
+        static constexpr std::size_t DEFAULT_ZC_SEND_THRESHOLD = 16 * 1024;
+        static void set_zc_send_threshold(std::size_t threshold) noexcept { zc_send_threshold_ = threshold; }
+        [[nodiscard]] static std::size_t zc_send_threshold() noexcept { return zc_send_threshold_; }
+
         class send_awaiter
         {
         public:
-            send_awaiter(std::uint32_t raw_fd, std::span<const std::uint8_t> buf) noexcept;
+            // buf_index >= 0: buf lies in that registered buffer (see SendBufferPool)
+            send_awaiter(std::uint32_t raw_fd, std::span<const std::uint8_t> buf, bool fixed = false,
+                         bool zero_copy = false, int buf_index = -1) noexcept;
 
             [[nodiscard]] bool await_ready() const noexcept { return false; }
-            void await_suspend(std::coroutine_handle<> coroutine) noexcept;
+
+            template <typename Promise>
+            void await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+            {
+                submit(coroutine);
+                scope_ = cancel_scope_of(coroutine);
+                if (scope_ != nullptr)
+                {
+                    scope_->bind(&IoUring::cancelOperation, &sqe_data_);
+                }
+            }
+
             [[nodiscard]] int await_resume() const noexcept;
 
         private:
+            void submit(std::coroutine_handle<> coroutine) noexcept;
+
+            // Zero-copy sends resume only after the notification CQE, so buf_ stays valid until then
+            static void on_zc_complete(sqe_data *data);
+            // Retries a fixed-buffer send as a regular one on kernels without the support
+            static void on_fixed_complete(sqe_data *data);
+
             mutable sqe_data sqe_data_;
+            cancel_scope *scope_ = nullptr;
             const std::uint32_t raw_fd_;
             const std::span<const std::uint8_t> buf_;
+            const bool fixed_;
+            const bool zero_copy_;
+            int buf_index_;
+            std::int32_t zc_result_ = 0;
         };
 
         [[nodiscard]] send_awaiter send(std::span<const std::uint8_t> buf) const noexcept;
+        // Pooled buffers go out with IORING_RECVSEND_FIXED_BUF; buf must outlive the co_await
+        [[nodiscard]] send_awaiter send(const send_buffer &buf) const noexcept;
+        // buf lies in registered buffer buf_index (e.g. the recv arena); it must outlive the co_await
+        [[nodiscard]] send_awaiter send(std::span<const std::uint8_t> buf, int buf_index) const noexcept;
+
+    private:
+        bool fixed_ = false;
+        // Worker whose ring holds the fixed-file slot (Mailbox::NO_WORKER off the workers)
+        std::size_t owner_worker_ = static_cast<std::size_t>(-1);
+        inline static std::size_t zc_send_threshold_ = DEFAULT_ZC_SEND_THRESHOLD;
     };
 
     class socket_server : public file
@@ -74,7 +247,8 @@ namespace co_uring
         public:
             multishot_accept_guard(std::uint32_t raw_fd,
                                    sockaddr_storage *client_address,
-                                   socklen_t *client_address_size) noexcept;
+                                   socklen_t *client_address_size,
+                                   bool direct = false) noexcept;
             ~multishot_accept_guard() noexcept;
 
             multishot_accept_guard(const multishot_accept_guard &) = delete;
@@ -92,13 +266,18 @@ namespace co_uring
             const std::uint32_t raw_fd_;
             sockaddr_storage *const client_address_;
             socklen_t *const client_address_size_;
+            const bool direct_;
         };
 
         [[nodiscard]] multishot_accept_guard &accept(sockaddr_storage *client_address = nullptr,
                                                      socklen_t *client_address_size = nullptr) noexcept;
 
+        // Accept into the fixed-file table (needs registerSparseFiles); set before the first accept()
+        void use_direct_descriptors(bool enabled) noexcept { direct_ = enabled; }
+
     private:
         std::optional<multishot_accept_guard> multishot_accept_guard_;
+        bool direct_ = false;
     };
 
     // Free function to create and bind a socket server
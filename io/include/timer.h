@@ -0,0 +1,56 @@
+#pragma once
+
+#include "io_uring.h"
+#include "../../coroutine/include/cancel_scope.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <linux/time_types.h>
+
+namespace co_uring
+{
+
+    // Suspends the coroutine on an IORING_OP_TIMEOUT in the worker's own ring,
+    // no timer thread or timerfd involved
+    class timer_awaiter
+    {
+    public:
+        timer_awaiter(std::chrono::nanoseconds value, bool absolute) noexcept;
+
+        timer_awaiter(const timer_awaiter &) = delete;
+        timer_awaiter &operator=(const timer_awaiter &) = delete;
+        timer_awaiter(timer_awaiter &&) noexcept = default;
+        timer_awaiter &operator=(timer_awaiter &&) = delete;
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+        // Cancellable through the awaiting task's scope (when_any losers)
+        template <typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+        {
+            submit(coroutine);
+            scope_ = cancel_scope_of(coroutine);
+            if (scope_ != nullptr)
+            {
+                scope_->bind(&IoUring::cancelOperation, &sqe_data_);
+            }
+        }
+
+        // 0 when the timer fired, -ECANCELED if it was cancelled
+        [[nodiscard]] int await_resume() const noexcept;
+
+    private:
+        void submit(std::coroutine_handle<> coroutine) noexcept;
+
+        mutable sqe_data sqe_data_;
+        cancel_scope *scope_ = nullptr;
+        __kernel_timespec ts_;
+        const bool absolute_;
+    };
+
+    [[nodiscard]] timer_awaiter sleep_for(std::chrono::nanoseconds duration) noexcept;
+
+    // steady_clock is CLOCK_MONOTONIC, the clock absolute io_uring timeouts use by default
+    [[nodiscard]] timer_awaiter sleep_until(std::chrono::steady_clock::time_point deadline) noexcept;
+
+} // namespace co_uring
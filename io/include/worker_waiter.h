@@ -0,0 +1,49 @@
+#pragma once
+
+#include "mailbox.h"
+#include "scheduler.h"
+#include "logger.h"
+#include <coroutine>
+#include <cstddef>
+
+namespace co_uring
+{
+
+    namespace detail
+    {
+
+        // A suspended coroutine and where to resume it: its worker's own ready queue when
+        // woken from the same thread, its Mailbox (a MSG_RING CQE) from any other. Shared by
+        // channels and the async mutex/semaphore/event.
+        struct worker_waiter
+        {
+            std::coroutine_handle<> handle;
+            Scheduler *scheduler = nullptr;
+            std::size_t worker = Mailbox::NO_WORKER;
+
+            void capture(std::coroutine_handle<> h) noexcept
+            {
+                handle = h;
+                scheduler = &Scheduler::getInstance();
+                worker = Mailbox::currentWorker();
+            }
+
+            void wake() const
+            {
+                if (scheduler == &Scheduler::getInstance())
+                {
+                    scheduler->schedule(handle);
+                    return;
+                }
+                const std::coroutine_handle<> h = handle;
+                if (!Mailbox::post(worker, [h]()
+                                   { h.resume(); }))
+                {
+                    LOG_ERROR("❌ worker {} is gone, waiting coroutine cannot resume", worker);
+                }
+            }
+        };
+
+    } // namespace detail
+
+} // namespace co_uring
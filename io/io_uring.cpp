@@ -1,11 +1,16 @@
 #include "include/io_uring.h"
 #include "include/buffer_ring.h"
+#include "include/scheduler.h"
+#include "include/coarse_clock.h"
 #include "include/logger.h"
 #include <iostream>
 #include <coroutine>
+#include <cstddef>
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <vector>
 #include <unistd.h>
 
 namespace co_uring
@@ -17,18 +22,103 @@ namespace co_uring
         return instance;
     }
 
-    IoUring::~IoUring() { io_uring_queue_exit(&io_uring_); }
+    IoUring::~IoUring()
+    {
+        if (initialized_)
+        {
+            io_uring_queue_exit(&io_uring_);
+        }
+    }
 
-    int IoUring::queueInit()
+    // Setup flag sets to try in order; later entries are fallbacks for older kernels
+    static std::vector<std::uint32_t> setupFlagCandidates(const IoUringOptions &options)
     {
-        int result = io_uring_queue_init(IO_URING_QUEUE_SIZE, &io_uring_, 0);
+        if (options.sqpoll)
+        {
+            // Task-run modes are rejected together with SQPOLL, the poller thread runs task work.
+            // SQPOLL needs CAP_SYS_NICE on older kernels, keep serving in interrupt-driven mode then.
+            return {IORING_SETUP_SQPOLL, 0};
+        }
+
+        switch (options.profile)
+        {
+        case SetupProfile::DEFER_TASKRUN:
+            return {IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN,
+                    IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG,
+                    IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG,
+                    0};
+        case SetupProfile::COOP_TASKRUN:
+            return {IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG,
+                    IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG,
+                    0};
+        case SetupProfile::DEFAULT:
+        default:
+            return {0};
+        }
+    }
+
+    int IoUring::queueInit(const IoUringOptions &options)
+    {
+        if (options.sqpoll && options.profile != SetupProfile::DEFAULT)
+        {
+            std::cerr << "io_uring setup profile ignored in SQPOLL mode" << std::endl;
+        }
+
+        int result = -EINVAL;
+        io_uring_params params = {};
+        for (std::uint32_t flags : setupFlagCandidates(options))
+        {
+            // Multishot operations post many CQEs per SQE, so the CQ is sized independently of the SQ
+            params = {};
+            params.flags = flags | IORING_SETUP_CQSIZE;
+            params.cq_entries = CQ_SIZE;
+
+            if (flags & IORING_SETUP_SQPOLL)
+            {
+                params.sq_thread_idle = options.sqpoll_idle_ms;
+
+                if (options.sqpoll_cpu >= 0)
+                {
+                    params.flags |= IORING_SETUP_SQ_AFF;
+                    params.sq_thread_cpu = static_cast<std::uint32_t>(options.sqpoll_cpu);
+                }
+
+                // Attached rings share the poller thread of wq_fd instead of spawning their own
+                if (options.attach_wq_fd >= 0)
+                {
+                    params.flags |= IORING_SETUP_ATTACH_WQ;
+                    params.wq_fd = static_cast<std::uint32_t>(options.attach_wq_fd);
+                }
+            }
+
+            result = io_uring_queue_init_params(IO_URING_QUEUE_SIZE, &io_uring_, &params);
+            if (result == 0)
+            {
+                break;
+            }
+
+            std::cerr << "io_uring setup flags 0x" << std::hex << flags << std::dec
+                      << " rejected: " << strerror(-result) << ", trying fallback" << std::endl;
+        }
+
         if (result < 0)
         {
             std::cerr << "Failed to initialize io_uring queue: " << strerror(-result) << std::endl;
             return result;
         }
 
-        std::cout << "IoUring queue initialized with size: " << IO_URING_QUEUE_SIZE << std::endl;
+        initialized_ = true;
+        setup_flags_ = params.flags;
+        features_ = params.features;
+        sqpoll_ = (params.flags & IORING_SETUP_SQPOLL) != 0;
+        cqe_budget_ = std::max<std::uint32_t>(options.cqe_budget, 1);
+
+        std::cout << "IoUring queue initialized with size: " << IO_URING_QUEUE_SIZE
+                  << ", CQ size: " << params.cq_entries
+                  << (sqpoll_ ? " (SQPOLL)" : "")
+                  << (hasSetupFlag(IORING_SETUP_DEFER_TASKRUN) ? " (DEFER_TASKRUN)" : "")
+                  << (hasSetupFlag(IORING_SETUP_COOP_TASKRUN) ? " (COOP_TASKRUN)" : "")
+                  << (hasSetupFlag(IORING_SETUP_SINGLE_ISSUER) ? " (SINGLE_ISSUER)" : "") << std::endl;
         return 0;
     }
 
@@ -36,92 +126,164 @@ namespace co_uring
     {
         LOG_INFO("🔄 IoUring::eventLoop starting - managing coroutine lifecycle");
 
-        while (true)
+        std::array<completion, CQE_BATCH_SIZE> batch;
+        auto &scheduler = Scheduler::getInstance();
+        auto &clock = CoarseClock::getInstance();
+        running_ = true;
+
+        while (running_)
         {
-            LOG_DEBUG("⏳ Waiting for io_uring events...");
-            auto result = submitAndWait(1);
-            if (!result)
+            flushPendingSqes();
+            // Deferred SQEs are waiting for CQ progress, or coroutines are ready to run:
+            // poll instead of sleeping on the next CQE
+            auto result = submitAndWait(pending_sqes_.empty() && !scheduler.hasReady() ? 1 : 0);
+            // One clock read for everything this pass handles: heartbeats, expiry, log stamps
+            clock.refresh();
+            if (result < 0)
             {
                 LOG_ERROR("❌ Failed to submit and wait: {}", result);
                 continue;
             }
-            LOG_DEBUG("📥 Received {} events", result);
 
-            std::uint32_t head = 0;
-            io_uring_cqe *cqe = nullptr;
-            int cqe_count = 0;
-
-            io_uring_for_each_cqe(&io_uring_, head, cqe)
+            // Reap in batches: copy CQEs out, release the CQ slots with one advance, then resume.
+            // The budget bounds the work per iteration so a completion flood cannot delay submits.
+            std::uint32_t budget = cqe_budget_;
+            while (budget > 0)
             {
-                cqe_count++;
-                auto *sqe_data_ptr = reinterpret_cast<sqe_data *>(io_uring_cqe_get_data(cqe));
-
-                if (sqe_data_ptr)
+                const std::uint32_t count = reapCompletions(batch.data(), std::min<std::uint32_t>(budget, CQE_BATCH_SIZE));
+                if (count == 0)
                 {
-                    sqe_data_ptr->cqe_res = cqe->res;
-                    sqe_data_ptr->cqe_flags = cqe->flags;
-
-                    LOG_DEBUG("🔍 Processing CQE #{} - res: {}, flags: 0x{:08x}", cqe_count, cqe->res, cqe->flags);
-
-                    void *coroutine_address = sqe_data_ptr->coroutine;
-                    io_uring_cqe_seen(&io_uring_, cqe);
-
-                    if (coroutine_address != nullptr)
-                    {
-                        LOG_DEBUG("▶️ Resuming coroutine - handle: 0x{:016x}", reinterpret_cast<uintptr_t>(coroutine_address));
-
-                        try
-                        {
-                            auto handle = std::coroutine_handle<>::from_address(coroutine_address);
-
-                            if (handle)
-                            {
-                                if (!handle.done())
-                                {
-                                    LOG_DEBUG("🔄 Coroutine is alive, resuming...");
-                                    handle.resume();
-                                    LOG_DEBUG("✅ Coroutine resumed successfully");
-                                }
-                                else
-                                {
-                                    LOG_WARN("⚠️ Coroutine already done, skipping resume");
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("❌ Invalid coroutine handle from address: 0x{:016x}", reinterpret_cast<uintptr_t>(coroutine_address));
-                            }
-                        }
-                        catch (const std::exception &e)
-                        {
-                            LOG_ERROR("💥 Exception during coroutine resume: {}", e.what());
-                        }
-                        catch (...)
-                        {
-                            LOG_ERROR("💥 Unknown exception during coroutine resume");
-                        }
-                    }
-                    else
-                    {
-                        LOG_WARN("⚠️ CQE has null coroutine address - orphaned operation");
-                    }
+                    break;
                 }
-                else
+
+                for (std::uint32_t i = 0; i < count; ++i)
                 {
-                    LOG_WARN("⚠️ CQE has null sqe_data - invalid operation");
-                    io_uring_cqe_seen(&io_uring_, cqe);
+                    dispatchCompletion(batch[i]);
                 }
+                budget -= count;
+                stats_.completions += count;
+            }
+
+            // Then a bounded slice of yielded / scheduled coroutines, so a busy one cannot
+            // hold back completions for every other session on this worker
+            scheduler.runReady();
+        }
+
+        LOG_INFO("⏹️ IoUring::eventLoop stopped");
+    }
+
+    std::uint32_t IoUring::reapCompletions(completion *out, std::uint32_t max_count)
+    {
+        std::array<io_uring_cqe *, CQE_BATCH_SIZE> cqes;
+        const std::uint32_t count = io_uring_peek_batch_cqe(&io_uring_, cqes.data(), max_count);
+
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            out[i].data = reinterpret_cast<sqe_data *>(io_uring_cqe_get_data(cqes[i]));
+            out[i].res = cqes[i]->res;
+            out[i].flags = cqes[i]->flags;
+        }
+
+        if (count > 0)
+        {
+            io_uring_cq_advance(&io_uring_, count);
+        }
+        return count;
+    }
+
+    void IoUring::dispatchCompletion(const completion &entry)
+    {
+        sqe_data *sqe_data_ptr = entry.data;
+        if (!sqe_data_ptr)
+        {
+            // Fire-and-forget requests (cancel, close) carry no sqe_data
+            LOG_DEBUG("CQE without sqe_data - res: {}", entry.res);
+            return;
+        }
+
+        // Filled per entry: a multishot request may have several CQEs in one batch
+        sqe_data_ptr->cqe_res = entry.res;
+        sqe_data_ptr->cqe_flags = entry.flags;
+
+        try
+        {
+            if (sqe_data_ptr->on_complete != nullptr)
+            {
+                sqe_data_ptr->on_complete(sqe_data_ptr);
+                return;
+            }
+
+            if (sqe_data_ptr->coroutine == nullptr)
+            {
+                LOG_WARN("⚠️ CQE has null coroutine address - orphaned operation");
+                return;
             }
 
-            if (cqe_count > 0)
+            auto handle = std::coroutine_handle<>::from_address(sqe_data_ptr->coroutine);
+            if (handle.done())
             {
-                LOG_DEBUG("📊 Processed {} CQEs in this batch", cqe_count);
+                LOG_WARN("⚠️ Coroutine already done, skipping resume");
+                return;
             }
+            handle.resume();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("💥 Exception during coroutine resume: {}", e.what());
+        }
+        catch (...)
+        {
+            LOG_ERROR("💥 Unknown exception during coroutine resume");
         }
     }
 
     int IoUring::submitAndWait(std::uint32_t wait_nr)
     {
+        if (sqpoll_)
+        {
+            // The poller thread consumes the SQ on its own. io_uring_submit only
+            // enters the kernel when the poller has gone idle and raised
+            // IORING_SQ_NEED_WAKEUP, so a busy loop stays syscall-free.
+            if (sqNeedsWakeup())
+            {
+                LOG_DEBUG("💤 SQPOLL thread idle, waking it up");
+            }
+
+            int result = io_uring_submit(&io_uring_);
+            if (result < 0)
+            {
+                std::cerr << "Failed to submit: " << strerror(-result) << std::endl;
+                return result;
+            }
+
+            // Only block in the kernel when there is nothing left to reap
+            if (io_uring_cq_ready(&io_uring_) < wait_nr)
+            {
+                io_uring_cqe *cqe = nullptr;
+                int wait_result = io_uring_wait_cqe(&io_uring_, &cqe);
+                if (wait_result < 0 && wait_result != -EINTR)
+                {
+                    std::cerr << "Failed to wait for CQE: " << strerror(-wait_result) << std::endl;
+                    return wait_result;
+                }
+            }
+
+            return result;
+        }
+
+        if (wait_nr == 0 && hasSetupFlag(IORING_SETUP_DEFER_TASKRUN))
+        {
+            // Deferred task work only runs on GETEVENTS enters; a plain submit would leave
+            // finished requests invisible while the loop keeps polling
+            int result = io_uring_submit_and_get_events(&io_uring_);
+            if (result < 0)
+            {
+                std::cerr << "Failed to submit and get events: " << strerror(-result) << std::endl;
+            }
+            return result;
+        }
+
+        // wait_nr > 0 enters with GETEVENTS, which also runs deferred/cooperative task work
         int result = io_uring_submit_and_wait(&io_uring_, wait_nr);
         if (result < 0)
         {
@@ -132,87 +294,292 @@ namespace co_uring
         return result;
     }
 
-    void IoUring::submitMultishotAcceptRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd,
-                                               sockaddr *client_addr, socklen_t *client_len)
+    int IoUring::submit()
     {
-        io_uring_sqe *sqe = io_uring_get_sqe(&io_uring_);
-        if (!sqe)
+        flushPendingSqes();
+        int result = io_uring_submit(&io_uring_);
+        if (result < 0)
         {
-            std::cerr << "Failed to get SQE for multishot accept" << std::endl;
-            return;
+            std::cerr << "Failed to submit: " << strerror(-result) << std::endl;
         }
+        return result;
+    }
 
-        io_uring_prep_multishot_accept(sqe, raw_fd, client_addr, client_len, 0);
-        io_uring_sqe_set_data(sqe, sqe_data_ptr);
-
-        // Submitted multishot accept request
+    bool IoUring::sqNeedsWakeup() const noexcept
+    {
+        return (__atomic_load_n(io_uring_.sq.kflags, __ATOMIC_ACQUIRE) & IORING_SQ_NEED_WAKEUP) != 0;
     }
 
-    void IoUring::submitRecvRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd)
+    io_uring_sqe *IoUring::acquireSqe()
     {
+        // Keep submission order: nothing jumps ahead of already deferred requests
+        if (!pending_sqes_.empty())
+        {
+            return nullptr;
+        }
+
         io_uring_sqe *sqe = io_uring_get_sqe(&io_uring_);
+        if (sqe)
+        {
+            return sqe;
+        }
+
+        // SQ is full: hand what we have to the kernel early and retry once
+        ++stats_.early_submits;
+        io_uring_submit(&io_uring_);
+        sqe = io_uring_get_sqe(&io_uring_);
         if (!sqe)
         {
-            std::cerr << "Failed to get SQE for recv" << std::endl;
-            return;
+            ++stats_.still_full;
         }
+        return sqe;
+    }
 
-        io_uring_prep_recv(sqe, raw_fd, nullptr, BUF_SIZE, 0);
-        io_uring_sqe_set_flags(sqe, IOSQE_BUFFER_SELECT);
-        io_uring_sqe_set_data(sqe, sqe_data_ptr);
-        sqe->buf_group = BUF_GROUP_ID;
+    template <typename Prep>
+    void IoUring::prepare(Prep &&prep)
+    {
+        if (io_uring_sqe *sqe = acquireSqe())
+        {
+            prep(sqe);
+            return;
+        }
 
-        // Submitted recv request
+        // Still no room (SQPOLL thread lagging or submit failed), park until the next loop iteration
+        pending_sqes_.emplace_back(std::forward<Prep>(prep));
+        ++stats_.deferred;
+        if (pending_sqes_.size() > stats_.deferred_peak)
+        {
+            stats_.deferred_peak = pending_sqes_.size();
+            LOG_WARN("⚠️ SQ full, deferred {} requests (early submits: {}, still full after submit: {})",
+                     stats_.deferred_peak, stats_.early_submits, stats_.still_full);
+        }
     }
 
-    void IoUring::submitSendRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, std::span<const std::uint8_t> buf)
+    void IoUring::flushPendingSqes()
     {
-        io_uring_sqe *sqe = io_uring_get_sqe(&io_uring_);
-        if (!sqe)
+        while (!pending_sqes_.empty())
         {
-            std::cerr << "Failed to get SQE for send" << std::endl;
-            return;
+            io_uring_sqe *sqe = io_uring_get_sqe(&io_uring_);
+            if (!sqe)
+            {
+                ++stats_.early_submits;
+                io_uring_submit(&io_uring_);
+                sqe = io_uring_get_sqe(&io_uring_);
+                if (!sqe)
+                {
+                    ++stats_.still_full;
+                    return;
+                }
+            }
+
+            pending_sqes_.front()(sqe);
+            pending_sqes_.pop_front();
+            ++stats_.retried;
         }
+    }
 
-        io_uring_prep_send(sqe, raw_fd, buf.data(), buf.size(), 0);
-        io_uring_sqe_set_data(sqe, sqe_data_ptr);
+    int IoUring::registerSparseFiles(std::uint32_t count)
+    {
+        int result = io_uring_register_files_sparse(&io_uring_, count);
+        if (result < 0)
+        {
+            std::cerr << "Failed to register sparse file table: " << strerror(-result) << std::endl;
+            return result;
+        }
 
-        // Submitted send request
+        std::cout << "Fixed file table registered with " << count << " slots" << std::endl;
+        return 0;
     }
 
-    void IoUring::submitSpliceRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd_in,
-                                      std::uint32_t raw_fd_out, std::uint32_t len)
+    int IoUring::registerBuffers(std::span<const iovec> buffers)
     {
-        io_uring_sqe *sqe = io_uring_get_sqe(&io_uring_);
-        if (!sqe)
+        if (fixed_buffer_slots_used_ + buffers.size() > FIXED_BUFFER_TABLE_SIZE)
         {
-            std::cerr << "Failed to get SQE for splice" << std::endl;
-            return;
+            std::cerr << "Fixed buffer table full (" << FIXED_BUFFER_TABLE_SIZE << " slots)" << std::endl;
+            return -ENOSPC;
+        }
+
+        // One sparse table shared by every component; each registration claims the next slots
+        if (!fixed_buffer_table_)
+        {
+            int result = io_uring_register_buffers_sparse(&io_uring_, FIXED_BUFFER_TABLE_SIZE);
+            if (result < 0)
+            {
+                std::cerr << "Failed to register sparse buffer table: " << strerror(-result) << std::endl;
+                return result;
+            }
+            fixed_buffer_table_ = true;
         }
 
-        io_uring_prep_splice(sqe, raw_fd_in, -1, raw_fd_out, -1, len, SPLICE_F_MORE);
-        io_uring_sqe_set_data(sqe, sqe_data_ptr);
+        const auto first = fixed_buffer_slots_used_;
+        int result = io_uring_register_buffers_update_tag(&io_uring_, first, buffers.data(), nullptr,
+                                                          static_cast<unsigned>(buffers.size()));
+        if (result < 0)
+        {
+            std::cerr << "Failed to register buffers: " << strerror(-result) << std::endl;
+            return result;
+        }
 
-        // Submitted splice request
+        fixed_buffer_slots_used_ += static_cast<std::uint32_t>(buffers.size());
+        std::cout << "Registered " << buffers.size() << " fixed buffers at slot " << first << std::endl;
+        return static_cast<int>(first);
     }
 
-    void IoUring::submitCancelRequest(sqe_data *sqe_data_ptr)
+    void IoUring::unregisterBuffers(std::uint32_t first_index, std::uint32_t count)
     {
-        io_uring_sqe *sqe = io_uring_get_sqe(&io_uring_);
-        if (!sqe)
+        if (!initialized_ || !fixed_buffer_table_)
         {
-            std::cerr << "Failed to get SQE for cancel" << std::endl;
             return;
         }
 
-        io_uring_prep_cancel(sqe, sqe_data_ptr, 0);
+        // Empty iovecs clear the slots and unpin their pages; the slots are not reused
+        std::vector<iovec> empty(count, iovec{nullptr, 0});
+        io_uring_register_buffers_update_tag(&io_uring_, first_index, empty.data(), nullptr, count);
+    }
+
+    void IoUring::submitMultishotAcceptRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd,
+                                               sockaddr *client_addr, socklen_t *client_len,
+                                               bool direct)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            if (direct)
+            {
+                io_uring_prep_multishot_accept_direct(sqe, raw_fd, client_addr, client_len, 0);
+            }
+            else
+            {
+                io_uring_prep_multishot_accept(sqe, raw_fd, client_addr, client_len, 0);
+            }
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
+
+    void IoUring::submitRecvRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, bool fixed,
+                                    std::uint16_t buf_group)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            // Length 0: the selected buffer's size bounds the read
+            io_uring_prep_recv(sqe, raw_fd, nullptr, 0, 0);
+            io_uring_sqe_set_flags(sqe, IOSQE_BUFFER_SELECT | (fixed ? IOSQE_FIXED_FILE : 0));
+            io_uring_sqe_set_data(sqe, sqe_data_ptr);
+            sqe->buf_group = buf_group; });
+    }
+
+    void IoUring::submitMultishotRecvRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, bool fixed,
+                                             std::uint16_t buf_group, bool bundle)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_recv_multishot(sqe, raw_fd, nullptr, 0, 0);
+            if (bundle)
+            {
+                sqe->ioprio |= RECVSEND_BUNDLE;
+            }
+            io_uring_sqe_set_flags(sqe, IOSQE_BUFFER_SELECT | (fixed ? IOSQE_FIXED_FILE : 0));
+            io_uring_sqe_set_data(sqe, sqe_data_ptr);
+            sqe->buf_group = buf_group; });
+    }
+
+    void IoUring::submitSendRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, std::span<const std::uint8_t> buf,
+                                    bool fixed, int buf_index)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_send(sqe, raw_fd, buf.data(), buf.size(), 0);
+            if (buf_index >= 0)
+            {
+                sqe->ioprio |= IORING_RECVSEND_FIXED_BUF;
+                sqe->buf_index = static_cast<__u16>(buf_index);
+            }
+            if (fixed)
+            {
+                io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+            }
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
+
+    void IoUring::submitSendZcRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd, std::span<const std::uint8_t> buf,
+                                      bool fixed, int buf_index)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            if (buf_index >= 0)
+            {
+                io_uring_prep_send_zc_fixed(sqe, raw_fd, buf.data(), buf.size(), 0, 0,
+                                            static_cast<unsigned>(buf_index));
+            }
+            else
+            {
+                io_uring_prep_send_zc(sqe, raw_fd, buf.data(), buf.size(), 0, 0);
+            }
+            if (fixed)
+            {
+                io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+            }
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
+
+    void IoUring::submitNopRequest(sqe_data *sqe_data_ptr)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_nop(sqe);
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
+
+    void IoUring::submitTimeoutRequest(sqe_data *sqe_data_ptr, __kernel_timespec *ts, bool absolute)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_timeout(sqe, ts, 0, absolute ? IORING_TIMEOUT_ABS : 0);
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
+
+    void IoUring::submitMsgRingRequest(sqe_data *sqe_data_ptr, int target_ring_fd, sqe_data *target_data)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_msg_ring(sqe, target_ring_fd, 0, reinterpret_cast<__u64>(target_data), 0);
+            io_uring_sqe_set_flags(sqe, IOSQE_CQE_SKIP_SUCCESS);
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
+
+    void IoUring::submitCloseDirectRequest(std::uint32_t file_index)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_close_direct(sqe, file_index);
+            io_uring_sqe_set_flags(sqe, IOSQE_CQE_SKIP_SUCCESS);
+            io_uring_sqe_set_data(sqe, nullptr); });
+    }
+
+    void IoUring::submitSpliceRequest(sqe_data *sqe_data_ptr, std::uint32_t raw_fd_in,
+                                      std::uint32_t raw_fd_out, std::uint32_t len)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_splice(sqe, raw_fd_in, -1, raw_fd_out, -1, len, SPLICE_F_MORE);
+            io_uring_sqe_set_data(sqe, sqe_data_ptr); });
+    }
 
-        // Submitted cancel request
+    void IoUring::submitCancelRequest(sqe_data *sqe_data_ptr)
+    {
+        prepare([=](io_uring_sqe *sqe)
+                {
+            io_uring_prep_cancel(sqe, sqe_data_ptr, 0);
+            // get_sqe does not clear user_data; a stale pointer would resume someone else
+            io_uring_sqe_set_data(sqe, nullptr); });
+    }
+
+    void IoUring::cancelOperation(void *target) noexcept
+    {
+        getInstance().submitCancelRequest(static_cast<sqe_data *>(target));
     }
 
     void IoUring::addBuf(io_uring_buf_ring *buf_ring,
                          std::uint8_t *buf, std::size_t buf_size,
-                         std::uint32_t buf_id)
+                         std::uint32_t buf_id, std::uint32_t ring_entries)
     {
         if (!buf_ring)
         {
@@ -226,56 +593,37 @@ namespace co_uring
             return;
         }
 
-        const std::uint32_t mask = io_uring_buf_ring_mask(BUF_RING_SIZE);
-        io_uring_buf_ring_add(buf_ring, buf, buf_size, buf_id, mask, buf_id);
+        // Offset is relative to the current tail, not the buffer id
+        const std::uint32_t mask = io_uring_buf_ring_mask(ring_entries);
+        io_uring_buf_ring_add(buf_ring, buf, buf_size, buf_id, mask, 0);
         io_uring_buf_ring_advance(buf_ring, 1);
 
         // Added buffer to ring
     }
 
-    int IoUring::setupBufRing(io_uring_buf_ring *buf_ring,
-                              const std::vector<std::vector<std::uint_least8_t>> &buf_list) noexcept
+    int IoUring::setupBufRing(io_uring_buf_ring *buf_ring, std::uint16_t group_id, std::uint32_t entries,
+                              std::uint16_t flags) noexcept
     {
-        try
-        {
-            // Initialize buffer ring structure
-            io_uring_buf_ring_init(buf_ring);
+        io_uring_buf_ring_init(buf_ring);
 
-            // Register buffer ring with kernel
-            io_uring_buf_reg buf_reg = {};
-            buf_reg.ring_addr = reinterpret_cast<__u64>(buf_ring);
-            buf_reg.ring_entries = BUF_RING_SIZE;
-            buf_reg.bgid = BUF_GROUP_ID;
+        io_uring_buf_reg buf_reg = {};
+        buf_reg.ring_addr = reinterpret_cast<__u64>(buf_ring);
+        buf_reg.ring_entries = entries;
+        buf_reg.bgid = group_id;
+        // The 16 bits after bgid are `pad` in older headers and `flags` in newer ones
+        std::memcpy(reinterpret_cast<std::uint8_t *>(&buf_reg) + offsetof(io_uring_buf_reg, bgid) + sizeof(buf_reg.bgid),
+                    &flags, sizeof(flags));
 
-            int result = io_uring_register_buf_ring(&io_uring_, &buf_reg, 0);
-            if (result < 0)
-            {
-                std::cerr << "Failed to register buffer ring: " << strerror(-result) << std::endl;
-                return result;
-            }
-
-            // Add all buffers to the ring
-            for (std::uint32_t i = 0; i < buf_list.size(); ++i)
+        int result = io_uring_register_buf_ring(&io_uring_, &buf_reg, 0);
+        if (result < 0)
+        {
+            if (flags == 0)
             {
-                io_uring_buf_ring_add(buf_ring,
-                                      const_cast<std::uint8_t *>(buf_list[i].data()),
-                                      buf_list[i].size(),
-                                      i,
-                                      io_uring_buf_ring_mask(buf_list.size()),
-                                      i);
+                std::cerr << "Failed to register buffer ring " << group_id << ": " << strerror(-result) << std::endl;
             }
-
-            // Submit all buffers at once
-            io_uring_buf_ring_advance(buf_ring, buf_list.size());
-
-            std::cout << "Buffer ring registered successfully with " << buf_list.size() << " buffers" << std::endl;
-
-            return 0;
-        }
-        catch (...)
-        {
-            return -ENOMEM;
+            return result;
         }
+        return 0;
     }
 
     int IoUring::decodeVoid(int result)
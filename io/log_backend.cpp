@@ -0,0 +1,750 @@
+#include "include/log_backend.h"
+#include "include/coarse_clock.h"
+#include <liburing.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace co_uring
+{
+
+    namespace
+    {
+        // Writes in flight on the writer's ring: one batch at a time, plus room for a retry
+        constexpr unsigned WRITER_QUEUE_DEPTH = 4;
+
+        // Set once this thread's ring has been released at thread exit; later log calls
+        // from other thread_local destructors go through the synchronous path
+        thread_local bool ring_released = false;
+
+        std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept
+        {
+            std::size_t size = 1;
+            while (size < value)
+            {
+                size <<= 1;
+            }
+            return size;
+        }
+
+        void writeAll(int fd, std::string_view data, std::atomic<std::uint64_t> &errors)
+        {
+            while (!data.empty())
+            {
+                const ssize_t written = ::write(fd, data.data(), data.size());
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                data.remove_prefix(static_cast<std::size_t>(written));
+            }
+        }
+    } // namespace
+
+    // Single-producer ring owned by one logging thread; the writer is the only consumer
+    struct LogBackend::log_ring
+    {
+        explicit log_ring(std::size_t capacity)
+            : records(std::make_unique<log_record[]>(capacity)), mask(capacity - 1) {}
+
+        std::unique_ptr<log_record[]> records;
+        const std::size_t mask;
+        std::string tag;
+        // Set by the owning thread on exit; the writer frees the ring once it is drained
+        std::atomic<bool> retired{false};
+
+        alignas(64) std::atomic<std::uint64_t> head{0};
+        alignas(64) std::atomic<std::uint64_t> tail{0};
+        // Producer only: last head seen, so a non-full ring needs no load of the writer's line
+        std::uint64_t cached_head = 0;
+    };
+
+    // The log file and the writer's io_uring. A batch is handed to the kernel as one
+    // IORING_OP_WRITE and stays in flight while the writer renders the next one; the
+    // file is opened O_APPEND, so writes land at the end. Without io_uring it falls
+    // back to write(2) on the writer thread.
+    class LogBackend::file_writer
+    {
+    public:
+        file_writer(LogBackend &owner, std::string path) : owner_(owner), path_(std::move(path)) {}
+
+        ~file_writer()
+        {
+            finish();
+            if (fd_ >= 0)
+            {
+                ::close(fd_);
+            }
+            if (ring_ready_)
+            {
+                io_uring_queue_exit(&ring_);
+            }
+        }
+
+        file_writer(const file_writer &) = delete;
+        file_writer &operator=(const file_writer &) = delete;
+
+        bool open()
+        {
+            std::error_code ec;
+            const std::filesystem::path log_path(path_);
+            if (log_path.has_parent_path())
+            {
+                std::filesystem::create_directories(log_path.parent_path(), ec);
+            }
+
+            fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd_ < 0)
+            {
+                return false;
+            }
+            struct stat st{};
+            size_ = ::fstat(fd_, &st) == 0 ? static_cast<std::size_t>(st.st_size) : 0;
+            opened_at_ = std::chrono::steady_clock::now();
+
+            if (!ring_ready_)
+            {
+                ring_ready_ = io_uring_queue_init(WRITER_QUEUE_DEPTH, &ring_, 0) == 0;
+            }
+            return true;
+        }
+
+        // Waits for the previous batch, then starts writing this one; batch comes back empty
+        void write(std::string &batch)
+        {
+            finish();
+            if (fd_ < 0)
+            {
+                owner_.write_errors_.fetch_add(1, std::memory_order_relaxed);
+                batch.clear();
+                return;
+            }
+
+            size_ += batch.size();
+            in_flight_.swap(batch);
+            batch.clear();
+            done_ = 0;
+            if (!ring_ready_)
+            {
+                writeAll(fd_, in_flight_, owner_.write_errors_);
+                owner_.bytes_.fetch_add(in_flight_.size(), std::memory_order_relaxed);
+                return;
+            }
+            submit();
+        }
+
+        // Waits until the batch in flight is fully written
+        void finish()
+        {
+            while (pending_)
+            {
+                io_uring_cqe *cqe = nullptr;
+                const int ret = io_uring_wait_cqe(&ring_, &cqe);
+                if (ret == -EINTR)
+                {
+                    continue;
+                }
+                pending_ = false;
+                if (ret < 0)
+                {
+                    owner_.write_errors_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                const int res = cqe->res;
+                io_uring_cqe_seen(&ring_, cqe);
+
+                if (res == -EINTR || res == -EAGAIN)
+                {
+                    submit();
+                    continue;
+                }
+                if (res <= 0)
+                {
+                    owner_.write_errors_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                done_ += static_cast<std::size_t>(res);
+                owner_.bytes_.fetch_add(static_cast<std::uint64_t>(res), std::memory_order_relaxed);
+                // Short write: queue the rest
+                if (done_ < in_flight_.size())
+                {
+                    submit();
+                }
+            }
+        }
+
+        [[nodiscard]] bool rotationDue(std::chrono::steady_clock::time_point now) const noexcept
+        {
+            const auto &options = owner_.options_;
+            return (options.rotate_bytes != 0 && size_ >= options.rotate_bytes) ||
+                   (options.rotate_interval.count() != 0 && now - opened_at_ >= options.rotate_interval);
+        }
+
+        // Renames the current file to <path>.<YYYYmmdd-HHMMSS> and starts a new one
+        void rotate()
+        {
+            finish();
+            ::close(fd_);
+            fd_ = -1;
+
+            const std::time_t now = std::time(nullptr);
+            std::tm local{};
+            localtime_r(&now, &local);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+
+            std::string target = path_ + "." + stamp;
+            std::error_code ec;
+            for (int n = 1; std::filesystem::exists(target, ec); ++n)
+            {
+                target = path_ + "." + stamp + "." + std::to_string(n);
+            }
+            if (std::rename(path_.c_str(), target.c_str()) != 0)
+            {
+                owner_.write_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (open())
+            {
+                owner_.rotations_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                owner_.write_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        void submit()
+        {
+            io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+            if (sqe == nullptr)
+            {
+                io_uring_submit(&ring_);
+                sqe = io_uring_get_sqe(&ring_);
+            }
+            // Offset -1: the file position, which O_APPEND keeps at the end
+            io_uring_prep_write(sqe, fd_, in_flight_.data() + done_, static_cast<unsigned>(in_flight_.size() - done_),
+                                static_cast<__u64>(-1));
+            io_uring_submit(&ring_);
+            pending_ = true;
+        }
+
+        LogBackend &owner_;
+        const std::string path_;
+        int fd_ = -1;
+        std::size_t size_ = 0;
+        std::chrono::steady_clock::time_point opened_at_;
+
+        io_uring ring_{};
+        bool ring_ready_ = false;
+        std::string in_flight_;
+        std::size_t done_ = 0;
+        bool pending_ = false;
+    };
+
+    LogBackend &LogBackend::getInstance() noexcept
+    {
+        static LogBackend instance;
+        return instance;
+    }
+
+    LogBackend::~LogBackend()
+    {
+        stop();
+    }
+
+    bool LogBackend::start(LogBackendOptions options)
+    {
+        if (running_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        options_ = std::move(options);
+        if (!options_.path.empty())
+        {
+            file_ = std::make_unique<file_writer>(*this, options_.path);
+            if (!file_->open())
+            {
+                file_.reset();
+                return false;
+            }
+        }
+
+        const bool binary = options_.format == LogFormat::BINARY;
+        if (binary)
+        {
+            // Once per process; later files get fresh sync points at the same rate
+            if (clock_.ticks == 0)
+            {
+                clock_ = binlog::calibrate(std::chrono::milliseconds(20));
+            }
+            header_pending_ = true;
+        }
+
+        reported_dropped_ = dropped_.load(std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+        running_.store(true, std::memory_order_release);
+        Logger::setBinaryOutput(binary);
+        writer_ = std::thread(&LogBackend::run, this);
+        return true;
+    }
+
+    void LogBackend::stop()
+    {
+        if (!running_.exchange(false, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        Logger::setBinaryOutput(false);
+
+        {
+            std::lock_guard lock(wake_mutex_);
+            wake_requested_ = true;
+        }
+        wake_cv_.notify_one();
+        writer_.join();
+
+        file_.reset();
+        std::lock_guard lock(rings_mutex_);
+        rings_.clear();
+    }
+
+    LogBackend::log_ring *LogBackend::ringForThread()
+    {
+        // Keeps this thread's ring registered until the thread exits
+        struct thread_ring
+        {
+            std::shared_ptr<log_ring> ring;
+            std::uint64_t generation = 0;
+
+            ~thread_ring()
+            {
+                if (ring)
+                {
+                    ring->retired.store(true, std::memory_order_release);
+                }
+                ring_released = true;
+            }
+        };
+        thread_local thread_ring current;
+
+        if (ring_released)
+        {
+            return nullptr;
+        }
+        const std::uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (current.ring && current.generation == generation)
+        {
+            return current.ring.get();
+        }
+
+        // First record from this thread since start()
+        auto ring = std::make_shared<log_ring>(roundUpToPowerOfTwo(options_.ring_records));
+        ring->tag = threadTag();
+        {
+            std::lock_guard lock(rings_mutex_);
+            rings_.push_back(ring);
+        }
+        current.ring = std::move(ring);
+        current.generation = generation;
+        return current.ring.get();
+    }
+
+    log_record *LogBackend::claim(log_ring *ring)
+    {
+        const std::size_t capacity = ring->mask + 1;
+        const std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        if (tail - ring->cached_head == capacity)
+        {
+            ring->cached_head = ring->head.load(std::memory_order_acquire);
+            if (tail - ring->cached_head == capacity)
+            {
+                wakeWriter();
+                if (options_.overflow == LogOverflow::DROP)
+                {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                blocked_.fetch_add(1, std::memory_order_relaxed);
+                do
+                {
+                    if (!isRunning())
+                    {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return nullptr;
+                    }
+                    std::this_thread::yield();
+                    ring->cached_head = ring->head.load(std::memory_order_acquire);
+                } while (tail - ring->cached_head == capacity);
+            }
+        }
+        return &ring->records[tail & ring->mask];
+    }
+
+    void LogBackend::publish(log_ring *ring)
+    {
+        const std::uint64_t tail = ring->tail.load(std::memory_order_relaxed) + 1;
+        ring->tail.store(tail, std::memory_order_release);
+
+        // Half full: do not leave it to the flush interval
+        if (tail - ring->cached_head == (ring->mask + 1) / 2)
+        {
+            wakeWriter();
+        }
+    }
+
+    bool LogBackend::push(LogLevel level, const char *file, int line, const char *func, std::string_view message)
+    {
+        log_ring *ring = ringForThread();
+        if (ring == nullptr)
+        {
+            return false;
+        }
+        log_record *record = claim(ring);
+        if (record == nullptr)
+        {
+            return true;
+        }
+
+        stamp(*record, level, file, line, func);
+        std::size_t length = std::min(message.size(), sizeof(record->text));
+        if (length < message.size())
+        {
+            // Cut on a UTF-8 boundary, not inside an emoji
+            while (length > 0 && (static_cast<unsigned char>(message[length]) & 0xC0) == 0x80)
+            {
+                --length;
+            }
+            truncated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::memcpy(record->text, message.data(), length);
+        record->length = static_cast<std::uint16_t>(length);
+        publish(ring);
+        return true;
+    }
+
+    std::uint32_t LogBackend::registerSite(log_site &site, std::string_view types)
+    {
+        std::lock_guard lock(sites_mutex_);
+        if (const std::uint32_t id = site.id.load(std::memory_order_relaxed); id != 0)
+        {
+            return id;
+        }
+
+        binlog::descriptor descriptor;
+        descriptor.id = static_cast<std::uint32_t>(sites_.size() + 1);
+        descriptor.level = static_cast<std::uint8_t>(site.level);
+        descriptor.line = static_cast<std::uint32_t>(site.line);
+        descriptor.file = site.file;
+        descriptor.func = site.func;
+        descriptor.format = site.format;
+        descriptor.types = types;
+        sites_.push_back(std::move(descriptor));
+
+        site.id.store(sites_.back().id, std::memory_order_release);
+        return sites_.back().id;
+    }
+
+    bool LogBackend::pushBinary(const log_site &site, const binlog::payload_writer &payload)
+    {
+        if (options_.format != LogFormat::BINARY || !isRunning())
+        {
+            return false;
+        }
+        log_ring *ring = ringForThread();
+        if (ring == nullptr)
+        {
+            return false;
+        }
+        log_record *record = claim(ring);
+        if (record == nullptr)
+        {
+            return true;
+        }
+
+        record->timestamp = static_cast<std::int64_t>(binlog::ticks());
+        record->site = site.id.load(std::memory_order_acquire);
+        record->level = site.level;
+        std::memcpy(record->text, payload.data(), payload.size());
+        record->length = static_cast<std::uint16_t>(payload.size());
+        if (payload.truncated())
+        {
+            truncated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        publish(ring);
+        return true;
+    }
+
+    void LogBackend::wakeWriter()
+    {
+        if (!writer_sleeping_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        {
+            std::lock_guard lock(wake_mutex_);
+            wake_requested_ = true;
+        }
+        wake_cv_.notify_one();
+    }
+
+    void LogBackend::run()
+    {
+        std::string file_batch;
+        std::string console_batch;
+        while (true)
+        {
+            // Read before draining, so the last pass after stop() sees every record
+            const bool stopping = !running_.load(std::memory_order_acquire);
+            const bool drained = drain(file_batch, console_batch);
+
+            if (!console_batch.empty())
+            {
+                writeAll(STDOUT_FILENO, console_batch, write_errors_);
+                console_batch.clear();
+            }
+            if (file_)
+            {
+                if (!file_batch.empty())
+                {
+                    file_->write(file_batch);
+                }
+                if (file_->rotationDue(std::chrono::steady_clock::now()))
+                {
+                    file_->rotate();
+                    // A binary file starts over with its header and descriptors
+                    header_pending_ = options_.format == LogFormat::BINARY;
+                }
+            }
+
+            if (drained)
+            {
+                continue;
+            }
+            if (stopping)
+            {
+                break;
+            }
+
+            std::unique_lock lock(wake_mutex_);
+            writer_sleeping_.store(true, std::memory_order_relaxed);
+            wake_cv_.wait_for(lock, options_.flush_interval, [this]
+                              { return wake_requested_; });
+            wake_requested_ = false;
+            writer_sleeping_.store(false, std::memory_order_relaxed);
+        }
+
+        if (file_)
+        {
+            file_->finish();
+        }
+    }
+
+    bool LogBackend::drain(std::string &file_batch, std::string &console_batch)
+    {
+        const bool to_file = file_ != nullptr;
+        const bool to_console = options_.console;
+        const bool binary = options_.format == LogFormat::BINARY;
+        bool drained = false;
+
+        const auto append = [&](const log_record &record, std::string_view thread)
+        {
+            const std::string_view message{record.text, record.length};
+            if (to_file)
+            {
+                if (binary)
+                {
+                    appendBinary(events_, record, thread);
+                }
+                else
+                {
+                    render(file_batch, record, message, thread, false);
+                }
+            }
+            if (to_console)
+            {
+                if (record.site != 0)
+                {
+                    renderBinary(console_batch, record, thread);
+                }
+                else
+                {
+                    render(console_batch, record, message, thread, options_.color);
+                }
+            }
+        };
+
+        {
+            std::lock_guard lock(rings_mutex_);
+            for (auto it = rings_.begin(); it != rings_.end();)
+            {
+                log_ring &ring = **it;
+                // Before tail: a retired ring's last records are then visible too
+                const bool retired = ring.retired.load(std::memory_order_acquire);
+                const std::uint64_t tail = ring.tail.load(std::memory_order_acquire);
+                const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+                for (std::uint64_t i = head; i != tail; ++i)
+                {
+                    append(ring.records[i & ring.mask], ring.tag);
+                }
+                if (tail != head)
+                {
+                    ring.head.store(tail, std::memory_order_release);
+                    written_.fetch_add(tail - head, std::memory_order_relaxed);
+                    drained = true;
+                }
+                it = retired ? rings_.erase(it) : it + 1;
+            }
+        }
+
+        const std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_dropped_)
+        {
+            log_record record;
+            stamp(record, LogLevel::WARN, "", 0, "");
+            const int length = std::snprintf(record.text, sizeof(record.text), "⚠️ %llu log records dropped (ring full)",
+                                             static_cast<unsigned long long>(dropped - reported_dropped_));
+            record.length = static_cast<std::uint16_t>(std::clamp<int>(length, 0, sizeof(record.text) - 1));
+            append(record, "log");
+            reported_dropped_ = dropped;
+        }
+
+        if (binary && to_file)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (header_pending_)
+            {
+                binlog::appendHeader(file_batch);
+                clock_ = clock_.resync();
+                binlog::appendClock(file_batch, clock_);
+                last_sync_ = now;
+                sites_written_ = 0;
+                header_pending_ = false;
+            }
+            // Every site an event in this batch refers to was registered before the
+            // event was published, so it is in sites_ by now
+            {
+                std::lock_guard lock(sites_mutex_);
+                for (; sites_written_ < sites_.size(); ++sites_written_)
+                {
+                    binlog::appendDescriptor(file_batch, sites_[sites_written_]);
+                }
+            }
+            // A fresh sync point every second keeps TSC drift out of decoded times
+            if (!events_.empty() && now - last_sync_ >= std::chrono::seconds(1))
+            {
+                clock_ = clock_.resync();
+                binlog::appendClock(file_batch, clock_);
+                last_sync_ = now;
+            }
+            file_batch += events_;
+            events_.clear();
+        }
+        return drained;
+    }
+
+    void LogBackend::appendBinary(std::string &out, const log_record &record, std::string_view thread)
+    {
+        const std::string_view message{record.text, record.length};
+        if (record.site != 0)
+        {
+            binlog::appendEvent(out, record.site, static_cast<std::uint64_t>(record.timestamp), thread, message);
+            return;
+        }
+        binlog::appendText(out, static_cast<std::uint8_t>(record.level), record.timestamp, thread, record.file,
+                           static_cast<std::uint32_t>(record.line), record.func, message);
+    }
+
+    void LogBackend::renderBinary(std::string &out, const log_record &record, std::string_view thread)
+    {
+        if (record.site > writer_sites_.size())
+        {
+            std::lock_guard lock(sites_mutex_);
+            writer_sites_.assign(sites_.begin(), sites_.end());
+        }
+        const binlog::descriptor &site = writer_sites_[record.site - 1];
+
+        std::string message;
+        binlog::formatPayload(message, site.format, site.types, {record.text, record.length});
+
+        log_record line;
+        stamp(line, static_cast<LogLevel>(site.level), site.file.c_str(), static_cast<int>(site.line),
+              site.func.c_str());
+        line.timestamp = clock_.toUnixNanos(static_cast<std::uint64_t>(record.timestamp));
+        render(out, line, message, thread, options_.color);
+    }
+
+    LogBackendStats LogBackend::getStats() const noexcept
+    {
+        LogBackendStats stats;
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        stats.blocked = blocked_.load(std::memory_order_relaxed);
+        stats.truncated = truncated_.load(std::memory_order_relaxed);
+        stats.bytes = bytes_.load(std::memory_order_relaxed);
+        stats.rotations = rotations_.load(std::memory_order_relaxed);
+        stats.write_errors = write_errors_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void LogBackend::stamp(log_record &record, LogLevel level, const char *file, int line, const char *func) noexcept
+    {
+        // The worker's cached time: at most one event-loop pass old
+        record.timestamp = CoarseClock::getInstance().unixNanos();
+        record.file = file;
+        record.func = func;
+        record.line = line;
+        record.site = 0;
+        record.level = level;
+    }
+
+    void LogBackend::render(std::string &out, const log_record &record, std::string_view message,
+                            std::string_view thread, bool color)
+    {
+        // Lines stamped in this event-loop pass share the clock's text, rendered on first use.
+        // The async writer's clock is never refreshed, so it formats each record's own time.
+        CoarseClock &clock = CoarseClock::getInstance();
+        char rendered[binlog::TIMESTAMP_LENGTH];
+        std::string_view timestamp;
+        if (clock.isActive() && record.timestamp == clock.unixNanos())
+        {
+            timestamp = clock.timestamp();
+        }
+        else
+        {
+            binlog::formatTimestamp(record.timestamp, rendered);
+            timestamp = std::string_view(rendered, sizeof(rendered));
+        }
+
+        binlog::appendLine(out, timestamp, static_cast<std::uint8_t>(record.level), thread, record.file, record.line,
+                           record.func, message, color);
+    }
+
+    std::string_view LogBackend::threadTag()
+    {
+        thread_local const std::string tag = []
+        {
+            std::ostringstream oss;
+            oss << std::this_thread::get_id();
+            std::string id = oss.str();
+            // Last 4 digits are enough to tell workers apart
+            return id.length() > 4 ? id.substr(id.length() - 4) : id;
+        }();
+        return tag;
+    }
+
+} // namespace co_uring
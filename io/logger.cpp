@@ -1,4 +1,5 @@
 #include "include/logger.h"
+#include "include/log_backend.h"
 #include <filesystem>
 #include <sstream>
 
@@ -43,9 +44,9 @@ namespace co_uring
         }
     }
 
-    void Logger::logMessage(LogLevel level, const std::string &file, int line, const std::string &func, const std::string &message)
+    void Logger::logMessage(LogLevel level, const char *file, int line, const char *func, std::string_view message)
     {
-        if (level < logLevel_)
+        if (!isEnabled(level))
         {
             return;
         }
@@ -53,128 +54,55 @@ namespace co_uring
         writeLog(level, file, line, func, message);
     }
 
-    void Logger::writeLog(LogLevel level, const std::string &file, int line, const std::string &func, const std::string &message)
+    bool Logger::writeBinary(log_site &site, std::string_view types, const binlog::payload_writer &payload)
     {
-        std::lock_guard<std::mutex> lock(logMutex_);
-
-        std::string timestamp = getCurrentTime();
-        std::string threadId = getThreadId();
-        std::string levelStr = getLevelString(level);
-
-        // 파일명에서 경로 제거
-        std::string filename = file;
-        if (!filename.empty())
+        auto &backend = LogBackend::getInstance();
+        if (site.id.load(std::memory_order_acquire) == 0)
         {
-            size_t pos = filename.find_last_of("/\\");
-            if (pos != std::string::npos)
-            {
-                filename = filename.substr(pos + 1);
-            }
+            backend.registerSite(site, types);
         }
+        return backend.pushBinary(site, payload);
+    }
 
-        // 로그 메시지 구성
-        std::ostringstream oss;
-        oss << "[" << timestamp << "] "
-            << "[" << levelStr << "] "
-            << "[T:" << threadId << "] ";
-
-        if (!filename.empty() && line > 0)
+    void Logger::writeLog(LogLevel level, const char *file, int line, const char *func, std::string_view message)
+    {
+        // 비동기 백엔드가 켜져 있으면 스레드별 링에 넣고 바로 반환
+        auto &backend = LogBackend::getInstance();
+        if (backend.isRunning() && backend.push(level, file, line, func, message))
         {
-            oss << "[" << filename << ":" << line;
-            if (!func.empty())
-            {
-                oss << " " << func << "()";
-            }
-            oss << "] ";
+            return;
         }
 
-        oss << message;
+        // 동기 경로: 시작 전/종료 후 로그, 종료 중인 스레드의 로그
+        log_record record;
+        LogBackend::stamp(record, level, file, line, func);
+        const std::string_view thread = LogBackend::threadTag();
+        std::string logMessage;
+        LogBackend::render(logMessage, record, message, thread, false);
 
-        std::string logMessage = oss.str();
+        std::lock_guard<std::mutex> lock(logMutex_);
 
         // 콘솔 출력
         if (consoleOutput_)
         {
             if (colorOutput_)
             {
-                std::cout << getColorCode(level) << logMessage << "\033[0m" << std::endl;
+                std::string colored;
+                LogBackend::render(colored, record, message, thread, true);
+                std::cout << colored << std::flush;
             }
             else
             {
-                std::cout << logMessage << std::endl;
+                std::cout << logMessage << std::flush;
             }
         }
 
         // 파일 출력
         if (logFile_ && logFile_->is_open())
         {
-            *logFile_ << logMessage << std::endl;
+            *logFile_ << logMessage;
             logFile_->flush();
         }
     }
 
-    std::string Logger::getCurrentTime()
-    {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-
-        std::ostringstream oss;
-        oss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-        oss << "." << std::setfill('0') << std::setw(3) << ms.count();
-
-        return oss.str();
-    }
-
-    std::string Logger::getThreadId()
-    {
-        std::ostringstream oss;
-        oss << std::this_thread::get_id();
-        std::string id = oss.str();
-
-        // Thread ID를 짧게 표시 (마지막 4자리만)
-        if (id.length() > 4)
-        {
-            return id.substr(id.length() - 4);
-        }
-        return id;
-    }
-
-    std::string Logger::getLevelString(LogLevel level)
-    {
-        switch (level)
-        {
-        case LogLevel::DEBUG:
-            return "DEBUG";
-        case LogLevel::INFO:
-            return "INFO ";
-        case LogLevel::WARN:
-            return "WARN ";
-        case LogLevel::ERROR:
-            return "ERROR";
-        default:
-            return "UNKNOWN";
-        }
-    }
-
-    std::string Logger::getColorCode(LogLevel level)
-    {
-        if (!colorOutput_)
-            return "";
-
-        switch (level)
-        {
-        case LogLevel::DEBUG:
-            return "\033[36m"; // Cyan
-        case LogLevel::INFO:
-            return "\033[32m"; // Green
-        case LogLevel::WARN:
-            return "\033[33m"; // Yellow
-        case LogLevel::ERROR:
-            return "\033[31m"; // Red
-        default:
-            return "\033[0m"; // Reset
-        }
-    }
-
 } // namespace co_uring
\ No newline at end of file
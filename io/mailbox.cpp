@@ -0,0 +1,240 @@
+#include "include/mailbox.h"
+#include "include/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace co_uring
+{
+
+    static std::array<std::atomic<Mailbox *>, Mailbox::MAX_WORKERS> mailbox_registry{};
+
+    namespace
+    {
+
+        // Attempts before a sender without an event loop gives up on a wakeup
+        constexpr int MAX_SEND_ATTEMPTS = 16;
+
+        // MSG_RING from a thread that does not run an event loop (compute pool, main). Nothing
+        // would ever reap a failure CQE on such a thread, so the result is waited for here, on
+        // a ring that carries nothing else.
+        class sender_ring
+        {
+        public:
+            sender_ring() noexcept : init_result_(io_uring_queue_init(ENTRIES, &ring_, 0)) {}
+
+            ~sender_ring()
+            {
+                if (init_result_ == 0)
+                {
+                    io_uring_queue_exit(&ring_);
+                }
+            }
+
+            sender_ring(const sender_ring &) = delete;
+            sender_ring &operator=(const sender_ring &) = delete;
+
+            // 0 once the CQE is in the target ring, otherwise a negative errno
+            int send(int target_ring_fd, sqe_data *target_data) noexcept
+            {
+                if (init_result_ != 0)
+                {
+                    return init_result_;
+                }
+
+                io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+                io_uring_prep_msg_ring(sqe, target_ring_fd, 0, reinterpret_cast<__u64>(target_data), 0);
+                io_uring_sqe_set_data(sqe, nullptr);
+
+                int result = io_uring_submit(&ring_);
+                if (result < 0)
+                {
+                    return result;
+                }
+
+                io_uring_cqe *cqe = nullptr;
+                do
+                {
+                    result = io_uring_wait_cqe(&ring_, &cqe);
+                } while (result == -EINTR);
+                if (result < 0)
+                {
+                    return result;
+                }
+                result = cqe->res;
+                io_uring_cqe_seen(&ring_, cqe);
+                return result;
+            }
+
+        private:
+            static constexpr unsigned ENTRIES = 4;
+
+            io_uring ring_{};
+            int init_result_;
+        };
+
+    } // namespace
+
+    Mailbox &Mailbox::getInstance() noexcept
+    {
+        thread_local Mailbox instance;
+        return instance;
+    }
+
+    Mailbox *Mailbox::forWorker(std::size_t worker_index) noexcept
+    {
+        if (worker_index >= MAX_WORKERS)
+        {
+            return nullptr;
+        }
+        return mailbox_registry[worker_index].load(std::memory_order_acquire);
+    }
+
+    std::size_t Mailbox::currentWorker() noexcept
+    {
+        return getInstance().worker_index_;
+    }
+
+    Mailbox::Mailbox() noexcept
+    {
+        wakeup_data_.on_complete = &Mailbox::on_wakeup;
+        wakeup_data_.context = this;
+
+        for (std::size_t i = 0; i < MAX_WORKERS; ++i)
+        {
+            send_data_[i].on_complete = &Mailbox::on_send_failed;
+            send_data_[i].context = reinterpret_cast<void *>(i);
+        }
+    }
+
+    Mailbox::~Mailbox()
+    {
+        detach();
+    }
+
+    void Mailbox::attach(std::size_t worker_index) noexcept
+    {
+        if (worker_index >= MAX_WORKERS)
+        {
+            std::cerr << "Mailbox: worker index " << worker_index << " exceeds " << MAX_WORKERS << std::endl;
+            return;
+        }
+
+        ring_fd_ = IoUring::getInstance().getRingFd();
+        worker_index_ = worker_index;
+        mailbox_registry[worker_index].store(this, std::memory_order_release);
+    }
+
+    void Mailbox::detach() noexcept
+    {
+        if (worker_index_ == NO_WORKER)
+        {
+            return;
+        }
+
+        Mailbox *self = this;
+        mailbox_registry[worker_index_].compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+        worker_index_ = NO_WORKER;
+    }
+
+    bool Mailbox::post(std::size_t worker_index, message fn)
+    {
+        Mailbox *target = forWorker(worker_index);
+        if (target == nullptr)
+        {
+            return false;
+        }
+
+        target->queue_.push(std::move(fn));
+        target->notify();
+        return true;
+    }
+
+    void Mailbox::notify()
+    {
+        // Coalesce: one MSG_RING per drain, however many producers push meanwhile
+        if (wakeup_pending_.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+
+        auto &ring = IoUring::getInstance();
+        if (ring.isRunning())
+        {
+            // Submitted on the next loop iteration; a failure comes back as a local CQE
+            // that this loop dispatches to on_send_failed
+            ring.submitMsgRingRequest(&getInstance().send_data_[worker_index_], ring_fd_, &wakeup_data_);
+            return;
+        }
+
+        // No loop to reap a failure here, so send synchronously and retry while the target
+        // is attached. A full target CQ (-EOVERFLOW) drains once its loop runs again.
+        thread_local sender_ring sender;
+        int result = 0;
+        for (int attempt = 0; attempt < MAX_SEND_ATTEMPTS; ++attempt)
+        {
+            result = sender.send(ring_fd_, &wakeup_data_);
+            if (result >= 0 || forWorker(worker_index_) != this)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50) * (1 << std::min(attempt, 6)));
+        }
+
+        if (result < 0)
+        {
+            // Leave the queue for the next post to wake, rather than never waking it again
+            LOG_ERROR("❌ Mailbox: wakeup to worker {} failed: {}", worker_index_, result);
+            wakeup_pending_.store(false, std::memory_order_release);
+        }
+    }
+
+    void Mailbox::drain()
+    {
+        // Clear before draining so a push that races with the drain sends a fresh wakeup
+        wakeup_pending_.store(false, std::memory_order_seq_cst);
+
+        message fn;
+        while (queue_.try_pop(fn))
+        {
+            ++delivered_;
+            try
+            {
+                fn();
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("💥 Exception in mailbox message: {}", e.what());
+            }
+        }
+    }
+
+    void Mailbox::on_wakeup(sqe_data *data)
+    {
+        static_cast<Mailbox *>(data->context)->drain();
+    }
+
+    void Mailbox::on_send_failed(sqe_data *data)
+    {
+        // Only failures post a local CQE (IOSQE_CQE_SKIP_SUCCESS); without a retry the
+        // target's pending flag would stay set and it would never be woken again
+        const auto worker_index = reinterpret_cast<std::size_t>(data->context);
+        LOG_WARN("⚠️ MSG_RING to worker {} failed: {}", worker_index, data->cqe_res);
+
+        if (Mailbox *target = forWorker(worker_index))
+        {
+            target->wakeup_pending_.store(false, std::memory_order_release);
+            target->notify();
+        }
+    }
+
+    bool switch_to_worker::await_suspend(std::coroutine_handle<> coroutine)
+    {
+        switched_ = Mailbox::post(worker_index_, [coroutine]()
+                                  { coroutine.resume(); });
+        // Target not running: stay on the current worker
+        return switched_;
+    }
+
+} // namespace co_uring
@@ -0,0 +1,59 @@
+#include "include/scheduler.h"
+#include "include/logger.h"
+#include <algorithm>
+#include <exception>
+
+namespace co_uring
+{
+
+    Scheduler &Scheduler::getInstance() noexcept
+    {
+        thread_local Scheduler instance;
+        return instance;
+    }
+
+    void Scheduler::schedule(std::coroutine_handle<> handle)
+    {
+        ready_.push_back(handle);
+        ++stats_.scheduled;
+        stats_.peak_ready = std::max(stats_.peak_ready, ready_.size());
+    }
+
+    std::size_t Scheduler::runReady()
+    {
+        // Snapshot: a coroutine that yields again goes behind everything already waiting
+        const std::size_t count = std::min<std::size_t>(ready_.size(), budget_);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto handle = ready_.front();
+            ready_.pop_front();
+            try
+            {
+                handle.resume();
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("💥 Exception during scheduled resume: {}", e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("💥 Unknown exception during scheduled resume");
+            }
+        }
+
+        stats_.resumed += count;
+        if (count == budget_ && !ready_.empty())
+        {
+            ++stats_.budget_exhausted;
+        }
+        return count;
+    }
+
+    void Scheduler::logStats() const
+    {
+        LOG_INFO("🗂️ scheduler: ready {}, peak {}, scheduled {}, resumed {}, budget {} exhausted {} times",
+                 ready_.size(), stats_.peak_ready, stats_.scheduled, stats_.resumed, budget_,
+                 stats_.budget_exhausted);
+    }
+
+} // namespace co_uring
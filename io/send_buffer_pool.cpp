@@ -0,0 +1,221 @@
+#include "include/send_buffer_pool.h"
+#include "include/io_uring.h"
+#include "include/logger.h"
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace co_uring
+{
+
+    // send_buffer implementation
+
+    send_buffer::~send_buffer() noexcept
+    {
+        release();
+    }
+
+    send_buffer::send_buffer(send_buffer &&other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          buf_index_(std::exchange(other.buf_index_, -1)),
+          class_index_(std::exchange(other.class_index_, 0)),
+          slot_(std::exchange(other.slot_, 0)),
+          pool_(std::exchange(other.pool_, nullptr)),
+          heap_(std::move(other.heap_))
+    {
+    }
+
+    send_buffer &send_buffer::operator=(send_buffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+            buf_index_ = std::exchange(other.buf_index_, -1);
+            class_index_ = std::exchange(other.class_index_, 0);
+            slot_ = std::exchange(other.slot_, 0);
+            pool_ = std::exchange(other.pool_, nullptr);
+            heap_ = std::move(other.heap_);
+        }
+        return *this;
+    }
+
+    void send_buffer::resize(std::size_t size) noexcept
+    {
+        size_ = std::min(size, capacity_);
+    }
+
+    bool send_buffer::append(std::span<const std::uint8_t> bytes) noexcept
+    {
+        if (bytes.size() > capacity_ - size_)
+        {
+            return false;
+        }
+        std::memcpy(data_ + size_, bytes.data(), bytes.size());
+        size_ += bytes.size();
+        return true;
+    }
+
+    void send_buffer::release() noexcept
+    {
+        if (pool_ != nullptr)
+        {
+            pool_->release(*this);
+        }
+        heap_.reset();
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+        buf_index_ = -1;
+        pool_ = nullptr;
+    }
+
+    // SendBufferPool implementation
+
+    SendBufferPool::~SendBufferPool()
+    {
+        if (registered_)
+        {
+            IoUring::getInstance().unregisterBuffers(static_cast<std::uint32_t>(buf_index_base_),
+                                                     static_cast<std::uint32_t>(SIZE_CLASSES.size()));
+        }
+        for (auto &a : arenas_)
+        {
+            if (a.base != nullptr)
+            {
+                munmap(a.base, a.length);
+            }
+        }
+    }
+
+    int SendBufferPool::init()
+    {
+        if (initialized_)
+        {
+            return 0;
+        }
+
+        std::array<iovec, SIZE_CLASSES.size()> iovecs{};
+        for (std::size_t i = 0; i < SIZE_CLASSES.size(); ++i)
+        {
+            const auto &cls = SIZE_CLASSES[i];
+            auto &a = arenas_[i];
+
+            a.length = cls.slot_size * cls.slot_count;
+            void *base = mmap(nullptr, a.length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+                              -1, 0);
+            if (base == MAP_FAILED)
+            {
+                const int error = errno;
+                LOG_ERROR("❌ SendBufferPool: mmap of {} bytes failed: {}", a.length, strerror(error));
+                return -error;
+            }
+            a.base = static_cast<std::uint8_t *>(base);
+
+            // Pop from the back hands out low slots first
+            a.free_slots.resize(cls.slot_count);
+            for (std::size_t slot = 0; slot < cls.slot_count; ++slot)
+            {
+                a.free_slots[slot] = static_cast<std::uint32_t>(cls.slot_count - 1 - slot);
+            }
+            a.stats.slot_size = cls.slot_size;
+            a.stats.slot_count = cls.slot_count;
+
+            iovecs[i].iov_base = a.base;
+            iovecs[i].iov_len = a.length;
+        }
+        initialized_ = true;
+
+        if (int first = IoUring::getInstance().registerBuffers(iovecs); first >= 0)
+        {
+            buf_index_base_ = first;
+            registered_ = true;
+        }
+        else
+        {
+            LOG_WARN("⚠️ SendBufferPool: buffer registration failed (RLIMIT_MEMLOCK?), sending from unregistered memory");
+        }
+        return 0;
+    }
+
+    send_buffer SendBufferPool::acquire(std::size_t size)
+    {
+        send_buffer buffer;
+
+        for (std::size_t i = 0; initialized_ && i < SIZE_CLASSES.size(); ++i)
+        {
+            if (SIZE_CLASSES[i].slot_size < size)
+            {
+                continue;
+            }
+
+            auto &a = arenas_[i];
+            if (a.free_slots.empty())
+            {
+                // Larger classes are scarcer, go straight to the heap instead of wasting one
+                ++a.stats.exhausted;
+                break;
+            }
+
+            const std::uint32_t slot = a.free_slots.back();
+            a.free_slots.pop_back();
+
+            ++a.stats.acquired;
+            ++a.stats.in_use;
+            a.stats.peak_in_use = std::max(a.stats.peak_in_use, a.stats.in_use);
+
+            buffer.data_ = a.base + static_cast<std::size_t>(slot) * SIZE_CLASSES[i].slot_size;
+            buffer.capacity_ = SIZE_CLASSES[i].slot_size;
+            buffer.size_ = size;
+            buffer.class_index_ = static_cast<std::uint32_t>(i);
+            buffer.slot_ = slot;
+            buffer.buf_index_ = registered_ ? buf_index_base_ + static_cast<int>(i) : -1;
+            buffer.pool_ = this;
+            return buffer;
+        }
+
+        if (size > SIZE_CLASSES.back().slot_size)
+        {
+            ++oversized_;
+        }
+
+        buffer.heap_ = std::make_unique_for_overwrite<std::uint8_t[]>(size);
+        buffer.data_ = buffer.heap_.get();
+        buffer.capacity_ = size;
+        buffer.size_ = size;
+        return buffer;
+    }
+
+    send_buffer SendBufferPool::copy(std::span<const std::uint8_t> bytes)
+    {
+        auto buffer = acquire(bytes.size());
+        if (!bytes.empty())
+        {
+            std::memcpy(buffer.data(), bytes.data(), bytes.size());
+        }
+        return buffer;
+    }
+
+    void SendBufferPool::release(send_buffer &buffer) noexcept
+    {
+        auto &a = arenas_[buffer.class_index_];
+        a.free_slots.push_back(buffer.slot_);
+        --a.stats.in_use;
+    }
+
+    SendBufferClassStats SendBufferPool::classStats(std::size_t class_index) const noexcept
+    {
+        if (class_index >= arenas_.size())
+        {
+            return {};
+        }
+        return arenas_[class_index].stats;
+    }
+
+} // namespace co_uring
@@ -2,12 +2,15 @@
 #include "include/io_uring.h"
 #include "include/buffer_ring.h"
 #include "include/logger.h"
+#include "include/scheduler.h"
+#include "include/mailbox.h"
 #include "../coroutine/include/task.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <cerrno>
@@ -23,8 +26,39 @@ namespace co_uring
 
     // socket_client implementation
 
-    socket_client::recv_awaiter::recv_awaiter(std::uint32_t raw_fd) noexcept
-        : raw_fd_(raw_fd)
+    socket_client::socket_client(std::uint32_t file_index, fixed_file_t) noexcept
+        : file(file_index), fixed_(true), owner_worker_(Mailbox::currentWorker())
+    {
+    }
+
+    socket_client::~socket_client() noexcept
+    {
+        if (!fixed_ || !raw_fd_.has_value())
+        {
+            return;
+        }
+
+        // Slot index is not a process fd, release it through the ring instead of ::close.
+        // Fixed-file tables are per ring, so it must be the ring that accepted it.
+        const std::uint32_t file_index = *raw_fd_;
+        raw_fd_.reset();
+        if (owner_worker_ == Mailbox::NO_WORKER || owner_worker_ == Mailbox::currentWorker())
+        {
+            IoUring::getInstance().submitCloseDirectRequest(file_index);
+            return;
+        }
+
+        // Last reference dropped on another worker (sessions are shared through SessionManager)
+        if (!Mailbox::post(owner_worker_, [file_index]()
+                           { IoUring::getInstance().submitCloseDirectRequest(file_index); }))
+        {
+            // The owner's ring, and its file table with it, is already gone
+            LOG_DEBUG("🔌 worker {} is gone, direct descriptor {} went with its ring", owner_worker_, file_index);
+        }
+    }
+
+    socket_client::recv_awaiter::recv_awaiter(std::uint32_t raw_fd, bool fixed) noexcept
+        : raw_fd_(raw_fd), fixed_(fixed)
     {
         LOG_DEBUG("📡 recv_awaiter created for fd: {}", raw_fd);
     }
@@ -35,17 +69,21 @@ namespace co_uring
         return false;
     }
 
-    void socket_client::recv_awaiter::await_suspend(std::coroutine_handle<> coroutine) noexcept
+    void socket_client::recv_awaiter::submit(std::coroutine_handle<> coroutine) noexcept
     {
         LOG_DEBUG("⏸️ recv_awaiter::await_suspend - fd: {}, coroutine: 0x{:016x}",
                   raw_fd_, reinterpret_cast<uintptr_t>(coroutine.address()));
         sqe_data_.coroutine = coroutine.address();
-        IoUring::getInstance().submitRecvRequest(&sqe_data_, raw_fd_);
+        IoUring::getInstance().submitRecvRequest(&sqe_data_, raw_fd_, fixed_);
         LOG_DEBUG("📤 recv_awaiter submitted SQE for fd: {}", raw_fd_);
     }
 
     int socket_client::recv_awaiter::await_resume() noexcept
     {
+        if (scope_ != nullptr)
+        {
+            scope_->unbind();
+        }
         LOG_DEBUG("▶️ recv_awaiter::await_resume - fd: {}, result: {}", raw_fd_, sqe_data_.cqe_res);
 
         if (sqe_data_.cqe_res < 0)
@@ -56,6 +94,10 @@ namespace co_uring
 
         buffer_id_ = sqe_data_.cqe_flags >> IORING_CQE_BUFFER_SHIFT;
         buffer_size_ = static_cast<std::uint32_t>(sqe_data_.cqe_res);
+        if (sqe_data_.cqe_flags & IORING_CQE_F_BUFFER)
+        {
+            buffer_offset_ = BufferRing::getInstance().noteSelected(buffer_id_, buffer_size_, sqe_data_.cqe_flags);
+        }
 
         LOG_DEBUG("📥 recv_awaiter success - fd: {}, buffer_id: {}, size: {}",
                   raw_fd_, buffer_id_, buffer_size_);
@@ -65,26 +107,361 @@ namespace co_uring
     socket_client::recv_awaiter socket_client::recv() const noexcept
     {
         LOG_DEBUG("🔄 socket_client::recv() creating awaiter for fd: {}", get_raw_fd());
-        return recv_awaiter{get_raw_fd()};
+        return recv_awaiter{get_raw_fd(), fixed_};
+    }
+
+    // recv_stream implementation
+
+    // A class change needs a cancel and re-arm, so wait for this many chunks of evidence
+    static constexpr std::uint32_t RECV_REGROUP_MIN_CHUNKS = 32;
+
+    socket_client::recv_stream::recv_stream(std::uint32_t raw_fd, bool fixed) noexcept
+        : state_(new state{})
+    {
+        state_->raw_fd_ = raw_fd;
+        state_->fixed_ = fixed;
+        state_->class_index_ = BufferRing::DEFAULT_CLASS;
+        state_->sqe_data_.on_complete = &state::on_complete;
+        state_->sqe_data_.context = state_.get();
+        LOG_DEBUG("📡 recv_stream created for fd: {}", raw_fd);
+    }
+
+    socket_client::recv_stream::~recv_stream() noexcept
+    {
+        if (!state_)
+        {
+            return;
+        }
+
+        // Hand back buffers of chunks the consumer never picked up
+        for (const auto &pending : state_->ready_)
+        {
+            if (pending.result > 0)
+            {
+                BufferRing::getInstance().returnBufs(pending.buffer_id, pending.buffer_count);
+            }
+        }
+        state_->ready_.clear();
+
+        if (state_->parked_)
+        {
+            // Not in the kernel, only in BufferRing's wait list
+            BufferRing::getInstance().unpark(state_.get());
+            return;
+        }
+
+        if (state_->armed_)
+        {
+            // Kernel still references sqe_data; the final CQE frees the state
+            state_->detached_ = true;
+            IoUring::getInstance().submitCancelRequest(&state_->sqe_data_);
+            state_.release();
+        }
+    }
+
+    void socket_client::recv_stream::state::arm() noexcept
+    {
+        armed_ = true;
+        IoUring::getInstance().submitMultishotRecvRequest(&sqe_data_, raw_fd_, fixed_,
+                                                          BufferRing::groupId(class_index_),
+                                                          BufferRing::getInstance().bundlesEnabled());
+        LOG_DEBUG("📤 recv_stream armed multishot recv for fd: {} (buffer group {})",
+                  raw_fd_, BufferRing::groupId(class_index_));
     }
 
-    socket_client::send_awaiter::send_awaiter(std::uint32_t raw_fd, std::span<const std::uint8_t> buf) noexcept
-        : raw_fd_(raw_fd), buf_(buf)
+    void socket_client::recv_stream::state::observe(std::uint32_t offset, std::uint32_t length) noexcept
     {
-        LOG_DEBUG("📡 send_awaiter created for fd: {}, size: {}", raw_fd, buf.size());
+        average_length_ = average_length_ == 0 ? length : (average_length_ * 7 + length) / 8;
+        ++chunks_since_switch_;
+
+        if (regrouping_ || !armed_)
+        {
+            return;
+        }
+
+        // A whole buffer filled by one read means it was cut short: step up at once. (A read
+        // ending at the tail of a partly used incremental buffer says nothing.) Otherwise
+        // pick the class that fits twice the average, once there is enough history.
+        const bool filled = offset == 0 && length >= BufferRing::bufferSize(class_index_);
+        const std::size_t wanted = filled ? std::min(class_index_ + 1, BufferRing::SIZE_CLASSES.size() - 1)
+                                          : BufferRing::classForLength(average_length_ * 2);
+        if (wanted == class_index_ || (!filled && chunks_since_switch_ < RECV_REGROUP_MIN_CHUNKS))
+        {
+            return;
+        }
+
+        target_class_ = wanted;
+        regrouping_ = true;
+        IoUring::getInstance().submitCancelRequest(&sqe_data_);
+    }
+
+    void socket_client::recv_stream::state::on_buffers_returned(void *context)
+    {
+        auto *self = static_cast<state *>(context);
+        self->parked_ = false;
+        self->arm();
     }
 
-    void socket_client::send_awaiter::await_suspend(std::coroutine_handle<> coroutine) noexcept
+    void socket_client::recv_stream::state::on_complete(sqe_data *data)
+    {
+        auto *self = static_cast<state *>(data->context);
+        const bool more = (data->cqe_flags & IORING_CQE_F_MORE) != 0;
+        const bool has_buffer = (data->cqe_flags & IORING_CQE_F_BUFFER) != 0;
+        const std::uint32_t buffer_id = data->cqe_flags >> IORING_CQE_BUFFER_SHIFT;
+        auto &buffer_ring = BufferRing::getInstance();
+
+        std::uint32_t offset = 0;
+        std::uint32_t buffer_count = has_buffer ? 1 : 0;
+        if (has_buffer)
+        {
+            const auto length = data->cqe_res > 0 ? static_cast<std::uint32_t>(data->cqe_res) : 0;
+            if (buffer_ring.bundlesEnabled() && length > 0)
+            {
+                buffer_count = buffer_ring.noteBundle(buffer_id, length);
+            }
+            else
+            {
+                offset = buffer_ring.noteSelected(buffer_id, length, data->cqe_flags);
+            }
+        }
+
+        bool regrouped = false;
+        if (!more)
+        {
+            self->armed_ = false;
+            if (self->regrouping_)
+            {
+                // Next arm() uses the new group
+                self->regrouping_ = false;
+                self->class_index_ = self->target_class_;
+                self->chunks_since_switch_ = 0;
+                regrouped = true;
+            }
+        }
+
+        if (self->detached_)
+        {
+            // Nobody will consume this chunk any more
+            if (has_buffer)
+            {
+                buffer_ring.returnBufs(buffer_id, buffer_count);
+            }
+            if (!more)
+            {
+                delete self;
+            }
+            return;
+        }
+
+        if (regrouped && data->cqe_res == -ECANCELED)
+        {
+            // Our own cancel, not the peer's doing
+            if (self->waiter_)
+            {
+                self->arm();
+            }
+            return;
+        }
+
+        if (data->cqe_res == -ENOBUFS)
+        {
+            // Group ran dry, not a socket error; re-arm once a buffer of this class comes back
+            self->parked_ = true;
+            buffer_ring.park(self->class_index_, &state::on_buffers_returned, self);
+            LOG_DEBUG("🅿️ recv_stream parked on buffer group {} for fd: {}",
+                      BufferRing::groupId(self->class_index_), self->raw_fd_);
+            return;
+        }
+
+        if (data->cqe_res > 0 && has_buffer && buffer_count == 0)
+        {
+            // Bundle could not be resolved (already released); surface it as an I/O error
+            self->ready_.push_back(chunk{-EIO, 0, 0, 0, 0});
+            self->finished_ = true;
+        }
+        else if (data->cqe_res > 0 && has_buffer)
+        {
+            const auto length = static_cast<std::uint32_t>(data->cqe_res);
+            self->ready_.push_back(chunk{data->cqe_res, buffer_id, offset, length, buffer_count});
+            // A bundle reports its first buffer's share, not the whole run
+            self->observe(offset, std::min(length, BufferRing::bufferSize(BufferRing::classOf(buffer_id))));
+        }
+        else if (data->cqe_res <= 0)
+        {
+            self->ready_.push_back(chunk{data->cqe_res, 0, 0, 0, 0});
+            self->finished_ = true;
+        }
+
+        if (self->waiter_)
+        {
+            // The consumer may destroy the stream, do not touch self afterwards
+            std::exchange(self->waiter_, {}).resume();
+        }
+    }
+
+    bool socket_client::recv_stream::next_awaiter::await_ready() const noexcept
+    {
+        return !stream_.state_->ready_.empty() || stream_.state_->finished_;
+    }
+
+    void socket_client::recv_stream::state::cancel_wait(void *target) noexcept
+    {
+        auto *self = static_cast<state *>(target);
+        if (!self->waiter_)
+        {
+            return;
+        }
+        // Resume from the ready queue, never inside the canceller
+        self->wait_cancelled_ = true;
+        Scheduler::getInstance().schedule(std::exchange(self->waiter_, {}));
+    }
+
+    void socket_client::recv_stream::next_awaiter::wait(std::coroutine_handle<> coroutine) noexcept
+    {
+        auto &st = *stream_.state_;
+        st.waiter_ = coroutine;
+        if (!st.armed_ && !st.parked_)
+        {
+            st.arm();
+        }
+    }
+
+    socket_client::recv_stream::chunk socket_client::recv_stream::next_awaiter::await_resume() noexcept
+    {
+        auto &st = *stream_.state_;
+        if (scope_ != nullptr)
+        {
+            scope_->unbind();
+        }
+        if (std::exchange(st.wait_cancelled_, false))
+        {
+            return chunk{-ECANCELED, 0, 0, 0, 0};
+        }
+        if (st.ready_.empty())
+        {
+            return chunk{};
+        }
+
+        chunk result = st.ready_.front();
+        st.ready_.pop_front();
+        return result;
+    }
+
+    socket_client::recv_stream socket_client::recv_multishot() const noexcept
+    {
+        return recv_stream{get_raw_fd(), fixed_};
+    }
+
+    // Cleared after the kernel rejects IORING_OP_SEND_ZC once on this worker
+    static thread_local bool zc_send_supported = true;
+    // Whether a plain send takes IORING_RECVSEND_FIXED_BUF (6.10+) on this worker. Only the
+    // first fixed sends decide it; once one went through, -EINVAL means a bad request
+    enum class fixed_buf_send_support
+    {
+        UNKNOWN,
+        SUPPORTED,
+        UNSUPPORTED,
+    };
+    static thread_local fixed_buf_send_support fixed_buf_send = fixed_buf_send_support::UNKNOWN;
+
+    socket_client::send_awaiter::send_awaiter(std::uint32_t raw_fd, std::span<const std::uint8_t> buf, bool fixed,
+                                              bool zero_copy, int buf_index) noexcept
+        : raw_fd_(raw_fd), buf_(buf), fixed_(fixed), zero_copy_(zero_copy && zc_send_supported),
+          buf_index_(zero_copy_ || fixed_buf_send != fixed_buf_send_support::UNSUPPORTED ? buf_index : -1)
+    {
+        LOG_DEBUG("📡 send_awaiter created for fd: {}, size: {}, zero-copy: {}", raw_fd, buf.size(), zero_copy_);
+    }
+
+    void socket_client::send_awaiter::submit(std::coroutine_handle<> coroutine) noexcept
     {
         LOG_DEBUG("⏸️ send_awaiter::await_suspend - fd: {}, coroutine: 0x{:016x}, size: {}",
                   raw_fd_, reinterpret_cast<uintptr_t>(coroutine.address()), buf_.size());
         sqe_data_.coroutine = coroutine.address();
-        IoUring::getInstance().submitSendRequest(&sqe_data_, raw_fd_, buf_);
+        if (zero_copy_)
+        {
+            sqe_data_.on_complete = &send_awaiter::on_zc_complete;
+            sqe_data_.context = this;
+            IoUring::getInstance().submitSendZcRequest(&sqe_data_, raw_fd_, buf_, fixed_, buf_index_);
+        }
+        else
+        {
+            if (buf_index_ >= 0)
+            {
+                sqe_data_.on_complete = &send_awaiter::on_fixed_complete;
+                sqe_data_.context = this;
+            }
+            IoUring::getInstance().submitSendRequest(&sqe_data_, raw_fd_, buf_, fixed_, buf_index_);
+        }
         LOG_DEBUG("📤 send_awaiter submitted SQE for fd: {}", raw_fd_);
     }
 
+    void socket_client::send_awaiter::on_zc_complete(sqe_data *data)
+    {
+        auto *self = static_cast<send_awaiter *>(data->context);
+
+        if (data->cqe_flags & IORING_CQE_F_NOTIF)
+        {
+            // Kernel released the pages, report the result of the first CQE
+            data->cqe_res = self->zc_result_;
+            std::coroutine_handle<>::from_address(data->coroutine).resume();
+            return;
+        }
+
+        self->zc_result_ = data->cqe_res;
+        if (data->cqe_flags & IORING_CQE_F_MORE)
+        {
+            // Notification still pending
+            return;
+        }
+
+        if (data->cqe_res == -EOPNOTSUPP || data->cqe_res == -EINVAL)
+        {
+            // No SEND_ZC on this kernel/socket: retry as a copying send and stop trying zero-copy
+            zc_send_supported = false;
+            data->on_complete = nullptr;
+            IoUring::getInstance().submitSendRequest(data, self->raw_fd_, self->buf_, self->fixed_);
+            return;
+        }
+
+        // Failed before any page was pinned, no notification follows
+        std::coroutine_handle<>::from_address(data->coroutine).resume();
+    }
+
+    void socket_client::send_awaiter::on_fixed_complete(sqe_data *data)
+    {
+        auto *self = static_cast<send_awaiter *>(data->context);
+        data->on_complete = nullptr;
+
+        if (data->cqe_res == -EINVAL && fixed_buf_send == fixed_buf_send_support::UNKNOWN)
+        {
+            // Plain send only takes registered buffers since 6.10; the bytes are ordinary memory too
+            LOG_WARN("⚠️ Kernel rejects fixed-buffer sends, pooled buffers go out as plain sends");
+            fixed_buf_send = fixed_buf_send_support::UNSUPPORTED;
+            self->buf_index_ = -1;
+            IoUring::getInstance().submitSendRequest(data, self->raw_fd_, self->buf_, self->fixed_);
+            return;
+        }
+
+        if (data->cqe_res == -EINVAL)
+        {
+            // Fixed sends work here, so the request itself is wrong (buf_index, span outside the slab)
+            LOG_ERROR("❌ Fixed-buffer send rejected - fd: {}, buf_index: {}, size: {}", self->raw_fd_,
+                      self->buf_index_, self->buf_.size());
+        }
+        else if (fixed_buf_send == fixed_buf_send_support::UNKNOWN)
+        {
+            fixed_buf_send = fixed_buf_send_support::SUPPORTED;
+        }
+
+        std::coroutine_handle<>::from_address(data->coroutine).resume();
+    }
+
     int socket_client::send_awaiter::await_resume() const noexcept
     {
+        if (scope_ != nullptr)
+        {
+            scope_->unbind();
+        }
         LOG_DEBUG("▶️ send_awaiter::await_resume - fd: {}, result: {}", raw_fd_, sqe_data_.cqe_res);
 
         if (sqe_data_.cqe_res < 0)
@@ -101,7 +478,20 @@ namespace co_uring
 
     socket_client::send_awaiter socket_client::send(std::span<const std::uint8_t> buf) const noexcept
     {
-        return send_awaiter{get_raw_fd(), buf};
+        const bool zero_copy = zc_send_threshold_ != 0 && buf.size() >= zc_send_threshold_;
+        return send_awaiter{get_raw_fd(), buf, fixed_, zero_copy};
+    }
+
+    socket_client::send_awaiter socket_client::send(const send_buffer &buf) const noexcept
+    {
+        const bool zero_copy = zc_send_threshold_ != 0 && buf.size() >= zc_send_threshold_;
+        return send_awaiter{get_raw_fd(), buf.span(), fixed_, zero_copy, buf.buf_index()};
+    }
+
+    socket_client::send_awaiter socket_client::send(std::span<const std::uint8_t> buf, int buf_index) const noexcept
+    {
+        const bool zero_copy = zc_send_threshold_ != 0 && buf.size() >= zc_send_threshold_;
+        return send_awaiter{get_raw_fd(), buf, fixed_, zero_copy, buf_index};
     }
 
     // socket_server implementation
@@ -113,10 +503,12 @@ namespace co_uring
 
     socket_server::multishot_accept_guard::multishot_accept_guard(std::uint32_t raw_fd,
                                                                   sockaddr_storage *client_address,
-                                                                  socklen_t *client_address_size) noexcept
+                                                                  socklen_t *client_address_size,
+                                                                  bool direct) noexcept
         : initial_await_(true), raw_fd_(raw_fd),
           client_address_(client_address),
-          client_address_size_(client_address_size) {}
+          client_address_size_(client_address_size),
+          direct_(direct) {}
 
     socket_server::multishot_accept_guard::~multishot_accept_guard() noexcept
     {
@@ -136,17 +528,27 @@ namespace co_uring
             IoUring::getInstance().submitMultishotAcceptRequest(
                 &sqe_data_, raw_fd_,
                 reinterpret_cast<sockaddr *>(client_address_),
-                client_address_size_);
+                client_address_size_, direct_);
             initial_await_ = false;
         }
     }
 
     socket_client *socket_server::multishot_accept_guard::await_resume() const noexcept
     {
+        // Multishot ends without IORING_CQE_F_MORE (e.g. -ENFILE on a full fixed-file table), re-arm on next await
+        if (!(sqe_data_.cqe_flags & IORING_CQE_F_MORE))
+        {
+            initial_await_ = true;
+        }
+
         if (sqe_data_.cqe_res < 0)
         {
             return nullptr;
         }
+        if (direct_)
+        {
+            return new socket_client{static_cast<std::uint32_t>(sqe_data_.cqe_res), fixed_file};
+        }
         return new socket_client{static_cast<std::uint32_t>(sqe_data_.cqe_res)};
     }
 
@@ -155,7 +557,7 @@ namespace co_uring
     {
         if (!multishot_accept_guard_.has_value())
         {
-            multishot_accept_guard_.emplace(get_raw_fd(), client_address, client_address_size);
+            multishot_accept_guard_.emplace(get_raw_fd(), client_address, client_address_size, direct_);
         }
         return *multishot_accept_guard_;
     }
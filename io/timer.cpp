@@ -0,0 +1,52 @@
+#include "include/timer.h"
+#include "include/logger.h"
+#include <cerrno>
+
+namespace co_uring
+{
+
+    timer_awaiter::timer_awaiter(std::chrono::nanoseconds value, bool absolute) noexcept
+        : absolute_(absolute)
+    {
+        const auto count = value.count() < 0 ? 0 : value.count();
+        ts_.tv_sec = count / 1'000'000'000;
+        ts_.tv_nsec = count % 1'000'000'000;
+    }
+
+    void timer_awaiter::submit(std::coroutine_handle<> coroutine) noexcept
+    {
+        sqe_data_.coroutine = coroutine.address();
+        IoUring::getInstance().submitTimeoutRequest(&sqe_data_, &ts_, absolute_);
+    }
+
+    int timer_awaiter::await_resume() const noexcept
+    {
+        if (scope_ != nullptr)
+        {
+            scope_->unbind();
+        }
+
+        // Expiry completes with -ETIME, which is the normal outcome here
+        if (sqe_data_.cqe_res == -ETIME)
+        {
+            return 0;
+        }
+
+        if (sqe_data_.cqe_res < 0 && sqe_data_.cqe_res != -ECANCELED)
+        {
+            LOG_WARN("⚠️ timer error: {}", sqe_data_.cqe_res);
+        }
+        return sqe_data_.cqe_res;
+    }
+
+    timer_awaiter sleep_for(std::chrono::nanoseconds duration) noexcept
+    {
+        return timer_awaiter{duration, false};
+    }
+
+    timer_awaiter sleep_until(std::chrono::steady_clock::time_point deadline) noexcept
+    {
+        return timer_awaiter{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()), true};
+    }
+
+} // namespace co_uring
@@ -1,10 +1,15 @@
 #include "server/include/server.h"
 #include "io/include/logger.h"
+#include "io/include/log_backend.h"
+#include <algorithm>
 #include <iostream>
 #include <signal.h>
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 
 using namespace co_uring;
 
@@ -16,7 +21,84 @@ void signal_handler(int signal)
     shutdown_requested.store(true);
 }
 
-int main()
+// 명령행 옵션을 서버 옵션으로 변환
+ServerOptions parse_options(int argc, char *argv[])
+{
+    ServerOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--sqpoll") == 0)
+        {
+            options.io_uring.sqpoll = true;
+        }
+        else if (std::strcmp(argv[i], "--direct-fd") == 0)
+        {
+            options.direct_descriptors = true;
+        }
+        else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            // default | coop | defer
+            const char *profile = argv[++i];
+            if (std::strcmp(profile, "coop") == 0)
+            {
+                options.io_uring.profile = SetupProfile::COOP_TASKRUN;
+            }
+            else if (std::strcmp(profile, "defer") == 0)
+            {
+                options.io_uring.profile = SetupProfile::DEFER_TASKRUN;
+            }
+            else if (std::strcmp(profile, "default") == 0)
+            {
+                options.io_uring.profile = SetupProfile::DEFAULT;
+            }
+            else
+            {
+                // 숫자 옵션의 std::stoul 실패와 같이 main의 catch에서 종료 코드 1로 끝남
+                throw std::invalid_argument(std::string("unknown --profile value: ") + profile +
+                                            " (default | coop | defer)");
+            }
+        }
+        else if (std::strcmp(argv[i], "--no-hugepages") == 0)
+        {
+            options.buffer_ring.hugepages = false;
+        }
+        else if (std::strcmp(argv[i], "--register-recv-buffers") == 0)
+        {
+            options.buffer_ring.register_fixed = true;
+        }
+        else if (std::strcmp(argv[i], "--no-incremental-buffers") == 0)
+        {
+            options.buffer_ring.incremental = false;
+        }
+        else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            options.tick_rate_hz = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--compute-threads") == 0 && i + 1 < argc)
+        {
+            options.compute_threads = std::stoul(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--ready-budget") == 0 && i + 1 < argc)
+        {
+            options.ready_budget = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--zc-threshold") == 0 && i + 1 < argc)
+        {
+            options.zc_send_threshold = std::stoul(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--binary-log") == 0)
+        {
+            // 로그 설정이므로 main에서 처리
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+        }
+    }
+    return options;
+}
+
+int main(int argc, char *argv[])
 {
     // Setup signal handlers
     signal(SIGINT, signal_handler);
@@ -27,13 +109,25 @@ int main()
         // Initialize logger
         auto &logger = co_uring::Logger::getInstance();
         logger.setLogLevel(co_uring::LogLevel::DEBUG);
-        logger.setLogFile("logs/gameserver.log");
         logger.setColorOutput(true);
 
+        // 로그는 워커 스레드에서 링에 넣기만 하고, 파일/콘솔 출력은 별도 writer 스레드가 처리
+        // --binary-log: 바이너리 형식으로 기록하고 tools/logdecode로 텍스트로 변환
+        const bool binary_log = std::any_of(argv + 1, argv + argc, [](const char *arg)
+                                            { return std::strcmp(arg, "--binary-log") == 0; });
+        LogBackendOptions log_options;
+        log_options.path = binary_log ? "logs/gameserver.blog" : "logs/gameserver.log";
+        log_options.format = binary_log ? LogFormat::BINARY : LogFormat::TEXT;
+        if (!LogBackend::getInstance().start(log_options))
+        {
+            logger.setLogFile(log_options.path);
+            LOG_WARN("⚠️ Async log backend unavailable, logging synchronously");
+        }
+
         LOG_INFO("=== Game Server Starting ===");
 
         // Create game server with hardware concurrency workers
-        GameServer server(4); // Use 4 worker threads
+        GameServer server(4, parse_options(argc, argv)); // Use 4 worker threads
         LOG_INFO("Created game server with {} worker threads", 4);
 
         // Start server on localhost:8080
@@ -60,6 +154,12 @@ int main()
         server.stop();
 
         LOG_INFO("=== Game Server Stopped ===");
+
+        LogBackend::getInstance().stop();
+        const LogBackendStats log_stats = LogBackend::getInstance().getStats();
+        LOG_INFO("📝 Log backend: {} written, {} dropped, {} blocked, {} truncated, {} rotations, {} write errors",
+                 log_stats.written, log_stats.dropped, log_stats.blocked, log_stats.truncated, log_stats.rotations,
+                 log_stats.write_errors);
     }
     catch (const std::exception &e)
     {
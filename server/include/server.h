@@ -3,34 +3,81 @@
 #include "../../io/include/socket.h"
 #include "../../io/include/buffer_ring.h"
 #include "../../io/include/io_uring.h"
+#include "../../io/include/mailbox.h"
+#include "../../io/include/scheduler.h"
+#include "../../io/include/compute_pool.h"
 #include "../../coroutine/include/task.h"
 #include "../../coroutine/include/spawn.h"
 #include "../../session/include/session_manager.h"
+#include "tick_driver.h"
 #include <memory>
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <future>
 #include <ranges>
 
 namespace co_uring
 {
 
+    struct ServerOptions
+    {
+        // Ring options applied to every worker
+        IoUringOptions io_uring;
+        // With SQPOLL, workers attach to the first worker's poller thread instead of one each
+        bool share_sqpoll = true;
+        // Per-worker poller CPU, indexed by worker; falls back to io_uring.sqpoll_cpu.
+        // With share_sqpoll there is one poller and only worker 0's entry applies, so start()
+        // rejects more than one entry
+        std::vector<int> sqpoll_cpus;
+        // Accept into a registered fixed-file table and do socket I/O with IOSQE_FIXED_FILE
+        bool direct_descriptors = false;
+        // Sends of at least this many bytes use IORING_OP_SEND_ZC, 0 disables zero-copy
+        std::size_t zc_send_threshold = socket_client::DEFAULT_ZC_SEND_THRESHOLD;
+        // Fixed-timestep game loop rate per worker, 0 disables the tick driver
+        std::uint32_t tick_rate_hz = 30;
+        // Receive buffer arena of each worker
+        BufferRingOptions buffer_ring;
+        // Yielded/scheduled coroutines each worker resumes per event-loop pass
+        std::uint32_t ready_budget = Scheduler::DEFAULT_BUDGET;
+        // Threads of the shared compute pool behind offload(); 0 uses the cores the workers leave free, at least 1
+        std::size_t compute_threads = 0;
+    };
+
+    // Options for one worker, resolved from ServerOptions by GameServer
+    struct WorkerOptions
+    {
+        IoUringOptions io_uring;
+        BufferRingOptions buffer_ring;
+        bool direct_descriptors = false;
+        std::uint32_t tick_rate_hz = 30;
+        std::uint32_t ready_budget = Scheduler::DEFAULT_BUDGET;
+    };
+
     class Worker
     {
     public:
-        void init(const char *host, std::uint16_t port);
+        explicit Worker(std::size_t index = 0) noexcept : index_(index) {}
+
+        // False if the ring, buffer ring or listening socket could not be set up; run() must not follow
+        [[nodiscard]] bool init(const char *host, std::uint16_t port, const WorkerOptions &options = {});
         void run();
         auto accept_clients() -> task<void>;
         auto handle_client(std::unique_ptr<socket_client> client) -> task<void>;
 
+        [[nodiscard]] std::size_t index() const noexcept { return index_; }
+        [[nodiscard]] TickDriver &tick_driver() noexcept { return tick_driver_; }
+
     private:
+        std::size_t index_;
         std::unique_ptr<socket_server> socket_server_;
+        TickDriver tick_driver_;
     };
 
     class GameServer
     {
     public:
-        explicit GameServer(std::size_t worker_count);
+        explicit GameServer(std::size_t worker_count, ServerOptions options = {});
         ~GameServer();
 
         bool start(const char *host, std::uint16_t port);
@@ -38,9 +85,13 @@ namespace co_uring
         void wait_for_shutdown();
 
     private:
-        void worker_thread_func(const char *host, std::uint16_t port);
+        void worker_thread_func(std::size_t index, const char *host, std::uint16_t port);
+        WorkerOptions worker_options(std::size_t index) const;
 
         std::size_t worker_count_;
+        ServerOptions options_;
+        std::promise<int> primary_ring_fd_;
+        int shared_wq_fd_ = -1;
         std::vector<std::thread> worker_threads_;
         std::atomic<bool> running_{false};
     };
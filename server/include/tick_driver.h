@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../../coroutine/include/task.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace co_uring
+{
+
+    // Tick timing statistics; lateness is how far past its deadline a tick started
+    struct TickStats
+    {
+        std::uint64_t ticks = 0;
+        // Ticks that started more than one period late; the missed ticks are skipped
+        std::uint64_t overruns = 0;
+        std::chrono::nanoseconds min_lateness = std::chrono::nanoseconds::max();
+        std::chrono::nanoseconds max_lateness{0};
+        double mean_lateness_us = 0.0;
+        double stddev_lateness_us = 0.0;
+    };
+
+    // Fixed-timestep game loop on the worker's own ring. Each tick is one absolute
+    // IORING_OP_TIMEOUT, so callbacks run on the I/O thread with no wakeups in between.
+    class TickDriver
+    {
+    public:
+        // tick: tick number, dt: fixed step
+        using tick_callback = std::function<void(std::uint64_t tick, std::chrono::nanoseconds dt)>;
+
+        explicit TickDriver(std::uint32_t tick_rate_hz = 30) noexcept;
+
+        void setTickRate(std::uint32_t tick_rate_hz) noexcept;
+        [[nodiscard]] std::uint32_t getTickRate() const noexcept { return tick_rate_hz_; }
+        [[nodiscard]] std::chrono::nanoseconds getPeriod() const noexcept { return period_; }
+
+        // Callbacks run in registration order every tick
+        void addTickCallback(tick_callback callback);
+
+        // Spawn once per worker after the ring is initialised
+        task<void> run();
+        void stop() noexcept { running_ = false; }
+
+        // Statistics since the last report window started
+        [[nodiscard]] TickStats getStats() const noexcept;
+
+    private:
+        void recordLateness(std::chrono::nanoseconds lateness) noexcept;
+        void reportStats();
+
+        std::uint32_t tick_rate_hz_;
+        std::chrono::nanoseconds period_;
+        std::vector<tick_callback> callbacks_;
+        bool running_ = false;
+
+        // Welford accumulators for the current report window
+        std::uint64_t samples_ = 0;
+        std::uint64_t overruns_ = 0;
+        double mean_us_ = 0.0;
+        double m2_us_ = 0.0;
+        std::chrono::nanoseconds min_lateness_ = std::chrono::nanoseconds::max();
+        std::chrono::nanoseconds max_lateness_{0};
+    };
+
+} // namespace co_uring
@@ -11,52 +11,94 @@
 namespace co_uring
 {
 
-    void Worker::init(const char *host, std::uint16_t port)
+    bool Worker::init(const char *host, std::uint16_t port, const WorkerOptions &options)
     {
         LOG_DEBUG("Worker::init starting - host: {}, port: {}", host ? host : "null", port);
 
         // Initialize io_uring for this worker thread
         auto &io_uring = IoUring::getInstance();
-        if (io_uring.queueInit() != 0)
+        if (io_uring.queueInit(options.io_uring) != 0)
         {
             LOG_ERROR("Failed to initialize io_uring queue");
-            return;
+            return false;
         }
         LOG_DEBUG("io_uring queue initialized successfully");
 
+        // Other workers reach this one through MSG_RING into its ring
+        Mailbox::getInstance().attach(index_);
+        Scheduler::getInstance().setBudget(options.ready_budget);
+
         // Initialize buffer ring for this worker thread
         auto &buffer_ring = BufferRing::getInstance();
-        if (buffer_ring.registerBufRing() != 0)
+        if (buffer_ring.registerBufRing(options.buffer_ring) != 0)
         {
             LOG_ERROR("Failed to register buffer ring");
-            return;
+            return false;
         }
         LOG_DEBUG("Buffer ring registered successfully");
 
+        // Registered outbound buffers; without them sends still work from the heap
+        if (SendBufferPool::getInstance().init() != 0)
+        {
+            LOG_WARN("Send buffer pool unavailable, outbound packets use heap buffers");
+        }
+
+        // Sparse fixed-file table for accept_direct; keep plain fds if the kernel refuses it
+        bool direct_descriptors = options.direct_descriptors;
+        if (direct_descriptors && io_uring.registerSparseFiles() != 0)
+        {
+            LOG_WARN("Fixed file table unavailable, using regular descriptors");
+            direct_descriptors = false;
+        }
+
         // Create and setup server socket
         auto socket_server = bind(host, port);
         if (!socket_server)
         {
             LOG_ERROR("Failed to create server socket for {}:{}", host ? host : "null", port);
-            return;
+            return false;
         }
         LOG_DEBUG("Server socket created successfully");
 
         if (socket_server->listen() != 0)
         {
             LOG_ERROR("Failed to listen on socket");
-            return;
+            return false;
         }
         LOG_DEBUG("Socket listening successfully");
 
         LOG_INFO("Worker initialized on {}:{}", host ? host : "0.0.0.0", port);
 
         socket_server_ = std::make_unique<co_uring::socket_server>(std::move(*socket_server));
+        socket_server_->use_direct_descriptors(direct_descriptors);
 
         // Start accepting clients (fire-and-forget)
         LOG_DEBUG("Starting accept_clients coroutine");
         spawn(accept_clients());
+
+        if (options.tick_rate_hz > 0)
+        {
+            tick_driver_.setTickRate(options.tick_rate_hz);
+
+            // Per-worker buffer group occupancy, coroutine frames and ready queue, once a minute;
+            // worker 0 also reports the shared compute pool
+            tick_driver_.addTickCallback([rate = options.tick_rate_hz, index = index_](std::uint64_t tick, std::chrono::nanoseconds)
+                                         {
+                if (tick > 0 && tick % (static_cast<std::uint64_t>(rate) * 60) == 0)
+                {
+                    BufferRing::getInstance().logStats();
+                    FrameAllocator::getInstance().logStats();
+                    Scheduler::getInstance().logStats();
+                    if (index == 0)
+                    {
+                        ComputePool::getInstance().logStats();
+                    }
+                } });
+
+            spawn(tick_driver_.run());
+        }
         LOG_DEBUG("Worker::init completed successfully");
+        return true;
     }
 
     void Worker::run()
@@ -103,7 +145,8 @@ namespace co_uring
         co_return;
     }
 
-    GameServer::GameServer(std::size_t worker_count) : worker_count_(worker_count)
+    GameServer::GameServer(std::size_t worker_count, ServerOptions options)
+        : worker_count_(worker_count), options_(std::move(options))
     {
     }
 
@@ -122,16 +165,43 @@ namespace co_uring
             return false;
         }
 
+        // Attached rings run on worker 0's poller; the kernel ignores their sq_thread_cpu
+        if (options_.io_uring.sqpoll && options_.share_sqpoll && options_.sqpoll_cpus.size() > 1)
+        {
+            LOG_ERROR("❌ share_sqpoll uses one poller, but sqpoll_cpus has {} entries", options_.sqpoll_cpus.size());
+            return false;
+        }
+
         running_.store(true);
         LOG_DEBUG("Set running flag to true");
 
+        socket_client::set_zc_send_threshold(options_.zc_send_threshold);
+        primary_ring_fd_ = std::promise<int>{};
+        shared_wq_fd_ = -1;
+
         LOG_INFO("Starting game server on {}:{}", host ? host : "0.0.0.0", port);
 
+        // CPU-heavy handler work runs here via co_await offload(...), off the I/O workers
+        std::size_t compute_threads = options_.compute_threads;
+        if (compute_threads == 0)
+        {
+            const std::size_t cores = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            compute_threads = cores > worker_count_ ? cores - worker_count_ : 1;
+        }
+        ComputePool::getInstance().start(compute_threads);
+
         // Start worker threads
         for (std::size_t i = 0; i < worker_count_; ++i)
         {
             LOG_DEBUG("Starting worker thread {}/{}", i + 1, worker_count_);
-            worker_threads_.emplace_back(&GameServer::worker_thread_func, this, host, port);
+            worker_threads_.emplace_back(&GameServer::worker_thread_func, this, i, host, port);
+
+            // Remaining workers attach to the first worker's SQPOLL backend, so its ring must exist first
+            if (i == 0 && options_.io_uring.sqpoll && options_.share_sqpoll)
+            {
+                shared_wq_fd_ = primary_ring_fd_.get_future().get();
+                LOG_INFO("Sharing SQPOLL backend of ring fd {}", shared_wq_fd_);
+            }
         }
 
         LOG_INFO("Game server started with {} workers", worker_count_);
@@ -152,6 +222,17 @@ namespace co_uring
         LOG_DEBUG("Set running flag to false");
 
         LOG_INFO("Stopping worker threads...");
+        for (std::size_t i = 0; i < worker_count_; ++i)
+        {
+            // The loop only exits from its own thread, so ask each worker to stop itself
+            if (!Mailbox::post(i, []()
+                               { IoUring::getInstance().stop(); }))
+            {
+                // Never attached: its init failed and the thread exits without a loop
+                LOG_WARN("Worker {} is not running", i);
+            }
+        }
+
         for (auto &thread : worker_threads_)
         {
             if (thread.joinable())
@@ -162,6 +243,9 @@ namespace co_uring
         }
 
         worker_threads_.clear();
+
+        // After the workers: a job finishing now has nobody to wake back, which is fine at shutdown
+        ComputePool::getInstance().stop();
         LOG_INFO("Game server stopped");
     }
 
@@ -181,12 +265,47 @@ namespace co_uring
         LOG_DEBUG("All worker threads finished");
     }
 
-    void GameServer::worker_thread_func(const char *host, std::uint16_t port)
+    WorkerOptions GameServer::worker_options(std::size_t index) const
     {
-        LOG_DEBUG("Worker thread starting for {}:{}", host ? host : "null", port);
+        WorkerOptions options;
+        options.io_uring = options_.io_uring;
+        options.buffer_ring = options_.buffer_ring;
+        options.direct_descriptors = options_.direct_descriptors;
+        options.tick_rate_hz = options_.tick_rate_hz;
+        options.ready_budget = options_.ready_budget;
+
+        if (index < options_.sqpoll_cpus.size())
+        {
+            options.io_uring.sqpoll_cpu = options_.sqpoll_cpus[index];
+        }
+        if (index > 0 && options_.share_sqpoll)
+        {
+            options.io_uring.attach_wq_fd = shared_wq_fd_;
+            options.io_uring.sqpoll_cpu = -1;
+        }
+        return options;
+    }
+
+    void GameServer::worker_thread_func(std::size_t index, const char *host, std::uint16_t port)
+    {
+        LOG_DEBUG("Worker thread {} starting for {}:{}", index, host ? host : "null", port);
+
+        Worker worker{index};
+        const bool initialized = worker.init(host, port, worker_options(index));
 
-        Worker worker;
-        worker.init(host, port);
+        if (index == 0 && options_.io_uring.sqpoll && options_.share_sqpoll)
+        {
+            auto &io_uring = IoUring::getInstance();
+            primary_ring_fd_.set_value(initialized && io_uring.isSqPoll() ? io_uring.getRingFd() : -1);
+        }
+
+        // Without a ring (or a listening socket) there is no loop to stop later; leave now so
+        // stop() can join this thread
+        if (!initialized)
+        {
+            LOG_ERROR("Worker {} failed to initialize, thread exiting", index);
+            return;
+        }
 
         // Run the io_uring event loop
         LOG_DEBUG("Worker thread entering event loop");
@@ -0,0 +1,111 @@
+#include "include/tick_driver.h"
+#include "../io/include/timer.h"
+#include "../io/include/logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace co_uring
+{
+
+    // Jitter statistics are logged and reset every this many seconds
+    static constexpr std::uint32_t TICK_STATS_REPORT_SECONDS = 10;
+
+    TickDriver::TickDriver(std::uint32_t tick_rate_hz) noexcept
+    {
+        setTickRate(tick_rate_hz);
+    }
+
+    void TickDriver::setTickRate(std::uint32_t tick_rate_hz) noexcept
+    {
+        tick_rate_hz_ = std::max<std::uint32_t>(tick_rate_hz, 1);
+        period_ = std::chrono::nanoseconds(1'000'000'000 / tick_rate_hz_);
+    }
+
+    void TickDriver::addTickCallback(tick_callback callback)
+    {
+        callbacks_.push_back(std::move(callback));
+    }
+
+    task<void> TickDriver::run()
+    {
+        LOG_INFO("⏱️ TickDriver started at {} Hz", tick_rate_hz_);
+
+        running_ = true;
+        std::uint64_t tick = 0;
+        auto deadline = std::chrono::steady_clock::now() + period_;
+
+        while (running_)
+        {
+            co_await sleep_until(deadline);
+
+            auto now = std::chrono::steady_clock::now();
+            auto lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline);
+            recordLateness(lateness);
+
+            for (auto &callback : callbacks_)
+            {
+                callback(tick, period_);
+            }
+            ++tick;
+
+            if (tick % (static_cast<std::uint64_t>(tick_rate_hz_) * TICK_STATS_REPORT_SECONDS) == 0)
+            {
+                reportStats();
+            }
+
+            // Fixed timestep: next deadline follows the schedule, not the wakeup time.
+            // A tick more than one period late drops the missed ticks instead of bursting to catch up.
+            deadline += period_;
+            if (lateness > period_)
+            {
+                ++overruns_;
+                const auto missed = lateness / period_;
+                deadline += period_ * missed;
+            }
+        }
+
+        LOG_INFO("⏹️ TickDriver stopped after {} ticks", tick);
+    }
+
+    void TickDriver::recordLateness(std::chrono::nanoseconds lateness) noexcept
+    {
+        const double value_us = static_cast<double>(lateness.count()) / 1000.0;
+        ++samples_;
+        const double delta = value_us - mean_us_;
+        mean_us_ += delta / static_cast<double>(samples_);
+        m2_us_ += delta * (value_us - mean_us_);
+
+        min_lateness_ = std::min(min_lateness_, lateness);
+        max_lateness_ = std::max(max_lateness_, lateness);
+    }
+
+    TickStats TickDriver::getStats() const noexcept
+    {
+        TickStats stats;
+        stats.ticks = samples_;
+        stats.overruns = overruns_;
+        stats.min_lateness = min_lateness_;
+        stats.max_lateness = max_lateness_;
+        stats.mean_lateness_us = mean_us_;
+        stats.stddev_lateness_us = samples_ > 1 ? std::sqrt(m2_us_ / static_cast<double>(samples_ - 1)) : 0.0;
+        return stats;
+    }
+
+    void TickDriver::reportStats()
+    {
+        auto stats = getStats();
+        LOG_INFO("📊 tick jitter ({} ticks @ {} Hz): min {}us, mean {}us, stddev {}us, max {}us, overruns {}",
+                 stats.ticks, tick_rate_hz_,
+                 stats.min_lateness.count() / 1000, static_cast<std::int64_t>(stats.mean_lateness_us),
+                 static_cast<std::int64_t>(stats.stddev_lateness_us), stats.max_lateness.count() / 1000,
+                 stats.overruns);
+
+        samples_ = 0;
+        overruns_ = 0;
+        mean_us_ = 0.0;
+        m2_us_ = 0.0;
+        min_lateness_ = std::chrono::nanoseconds::max();
+        max_lateness_ = std::chrono::nanoseconds{0};
+    }
+
+} // namespace co_uring
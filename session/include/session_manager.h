@@ -2,12 +2,15 @@
 
 #include "../../io/include/socket.h"
 #include "../../io/include/logger.h"
+#include "../../io/include/coarse_clock.h"
+#include "../../io/include/async_sync.h"
 #include "../../coroutine/include/task.h"
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
-#include <shared_mutex>
 #include <chrono>
+#include <span>
 #include <random>
 #include <cstdint>
 
@@ -23,7 +26,7 @@ namespace co_uring
         std::uint32_t experience = 0;
         std::chrono::steady_clock::time_point last_activity;
 
-        PlayerData() : last_activity(std::chrono::steady_clock::now()) {}
+        PlayerData() : last_activity(CoarseClock::getInstance().now()) {}
     };
 
     // 게임 세션 클래스
@@ -40,6 +43,7 @@ namespace co_uring
 
         // 하트비트 관리
         void UpdateHeartbeat() noexcept;
+        std::chrono::steady_clock::time_point GetLastHeartbeat() const noexcept { return last_heartbeat_; }
         bool IsExpired(std::chrono::minutes timeout = std::chrono::minutes{30}) const noexcept;
 
         // 이벤트 핸들러
@@ -49,8 +53,17 @@ namespace co_uring
 
         // 데이터 전송
         task<void> SendData(std::vector<std::uint8_t> &&buffer);
+        // 워커의 SendBufferPool에서 받은 버퍼는 등록된 고정 버퍼로 전송
+        task<void> SendData(send_buffer &&buffer);
+
+        // 워커마다 수신 버퍼를 붙잡은 채 진행 중인 에코 전송 수 상한 (64KB 그룹 32개의 절반).
+        // 느린 클라이언트로의 전송이 링의 버퍼를 모두 묶어 두지 못하게 하며, 넘치면 복사해서 전송
+        static constexpr std::size_t MAX_PINNED_RECV_SENDS = 16;
 
     private:
+        // 고정 버퍼로 등록된 수신 아레나의 조각을 복사 없이 그대로 전송하고, 끝나면 버퍼를 링에 반환
+        task<void> SendRecvSlice(std::span<const std::uint8_t> data, std::uint32_t buf_id);
+
         std::unique_ptr<socket_client> client_;
         std::string session_id_;
         PlayerData player_data_;
@@ -64,24 +77,33 @@ namespace co_uring
     public:
         static SessionManager &GetInstance() noexcept;
 
-        // 세션 관리
-        std::string AddSession(std::unique_ptr<socket_client> client);
-        std::shared_ptr<GameSession> GetSession(const std::string &session_id);
-        void RemoveSession(const std::string &session_id);
+        // 세션 관리: 맵은 async_mutex로 보호하므로 다른 워커가 잡고 있어도 스레드가 아닌 코루틴만 대기
+        task<std::string> AddSession(std::unique_ptr<socket_client> client);
+        task<std::shared_ptr<GameSession>> GetSession(std::string session_id);
+        task<void> RemoveSession(std::string session_id);
 
-        // 정리 작업
-        void CleanupExpiredSessions();
-        std::size_t GetActiveSessionCount() const noexcept;
+        // 만료 정리는 각 HandleSession의 유휴 타이머가 담당 (다른 워커가 맵에서 지우면 세션 코루틴과 소켓이 남음)
+        std::size_t GetActiveSessionCount() const noexcept { return session_count_.load(std::memory_order_relaxed); }
 
         // 세션 처리 코루틴
         task<void> HandleSession(std::shared_ptr<GameSession> session);
 
+        // 이만큼 연속으로 처리한 세션은 yield해서 같은 워커의 다른 세션에 차례를 넘김
+        static constexpr std::uint32_t CHUNKS_PER_YIELD = 32;
+        // 이 시간 동안 아무것도 받지 못한 세션은 대기 중인 recv를 취소하고 종료
+        static constexpr std::chrono::seconds RECV_IDLE_TIMEOUT{30};
+
     private:
         SessionManager() = default;
+        // HandleSession이 when_any로 함께 돌리는 수신 루프와 세션당 유휴 마감
+        static task<void> ReceiveLoop(GameSession &session, socket_client::recv_stream &stream);
+        static task<void> IdleDeadline(const GameSession &session);
         std::string GenerateSessionId();
 
-        mutable std::shared_mutex mutex_;
+        async_mutex mutex_;
         std::unordered_map<std::string, std::shared_ptr<GameSession>> sessions_;
+        // 잠금 없이 읽는 세션 수 (mutex_ 안에서만 갱신)
+        std::atomic<std::size_t> session_count_{0};
     };
 
     // 세션 핸들러 코루틴 함수
@@ -1,7 +1,11 @@
 #include "include/session_manager.h"
 #include "../io/include/buffer_ring.h"
+#include "../io/include/scheduler.h"
+#include "../io/include/timer.h"
+#include "../coroutine/include/when.h"
 #include "../coroutine/include/spawn.h"
 #include <algorithm>
+#include <cerrno>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -9,10 +13,20 @@
 namespace co_uring
 {
 
+    namespace
+    {
+        // 수신 버퍼를 붙잡는 에코 전송 허가: 워커마다 따로 두므로 대기자 깨우기도 같은 워커에서 끝남
+        async_semaphore &PinnedSendPermits() noexcept
+        {
+            thread_local async_semaphore permits{GameSession::MAX_PINNED_RECV_SENDS};
+            return permits;
+        }
+    }
+
     // GameSession 구현
     GameSession::GameSession(std::unique_ptr<socket_client> client, std::string session_id)
         : client_(std::move(client)), session_id_(std::move(session_id)),
-          last_heartbeat_(std::chrono::steady_clock::now())
+          last_heartbeat_(CoarseClock::getInstance().now())
     {
         LOG_INFO("🎮 GameSession 생성: {}", session_id_);
     }
@@ -24,13 +38,14 @@ namespace co_uring
 
     void GameSession::UpdateHeartbeat() noexcept
     {
-        last_heartbeat_ = std::chrono::steady_clock::now();
+        // 패킷마다 시계를 읽지 않고 이벤트 루프가 갱신한 워커 시각을 사용
+        last_heartbeat_ = CoarseClock::getInstance().now();
         player_data_.last_activity = last_heartbeat_;
     }
 
     bool GameSession::IsExpired(std::chrono::minutes timeout) const noexcept
     {
-        return std::chrono::steady_clock::now() - last_heartbeat_ > timeout;
+        return CoarseClock::getInstance().now() - last_heartbeat_ > timeout;
     }
 
     void GameSession::OnConnected()
@@ -52,7 +67,21 @@ namespace co_uring
         UpdateHeartbeat();
 
         // 기본적으로 에코 구현 (테스트용)
-        std::vector<std::uint8_t> echo_data(buffer, buffer + len);
+        auto &buffer_ring = BufferRing::getInstance();
+        if (buffer_ring.fixedBufIndex() >= 0)
+        {
+            // --register-recv-buffers: 수신 버퍼에서 바로 보내고, 전송이 끝날 때까지 버퍼를 붙잡아 둠
+            // (상한에 닿으면 링에 버퍼가 남도록 아래 복사 경로로 전송)
+            const std::uint32_t buf_id = buffer_ring.bufIdAt(buffer);
+            if (buf_id != BufferRing::NO_BUFFER && PinnedSendPermits().try_acquire())
+            {
+                buffer_ring.retainBuf(buf_id);
+                spawn(SendRecvSlice(std::span<const std::uint8_t>(buffer, len), buf_id));
+                return;
+            }
+        }
+
+        auto echo_data = SendBufferPool::getInstance().copy(std::span<const std::uint8_t>(buffer, len));
         spawn(SendData(std::move(echo_data)));
     }
 
@@ -84,6 +113,54 @@ namespace co_uring
         }
     }
 
+    task<void> GameSession::SendData(send_buffer &&buffer)
+    {
+        if (!client_ || !connected_.load())
+        {
+            LOG_WARN("⚠️ 연결되지 않은 세션에 데이터 전송 시도: {}", session_id_);
+            co_return;
+        }
+
+        // 전송이 끝날 때까지 코루틴 프레임이 버퍼 슬롯을 소유
+        send_buffer owned = std::move(buffer);
+        auto result = co_await client_->send(owned);
+
+        if (result >= 0)
+        {
+            LOG_DEBUG("📤 데이터 전송 완료: 세션 {} - {} bytes (buf_index {})", session_id_, result, owned.buf_index());
+        }
+        else
+        {
+            LOG_ERROR("❌데이터 전송 실패: 세션 {} - error code {}", session_id_, result);
+        }
+    }
+
+    task<void> GameSession::SendRecvSlice(std::span<const std::uint8_t> data, std::uint32_t buf_id)
+    {
+        auto &buffer_ring = BufferRing::getInstance();
+        if (!client_ || !connected_.load())
+        {
+            LOG_WARN("⚠️ 연결되지 않은 세션에 데이터 전송 시도: {}", session_id_);
+            buffer_ring.returnBuf(buf_id);
+            PinnedSendPermits().release();
+            co_return;
+        }
+
+        auto result = co_await client_->send(data, buffer_ring.fixedBufIndex());
+        // 커널이 더 이상 이 바이트를 읽지 않으므로 OnRecvData에서 붙잡은 참조와 허가를 놓음
+        buffer_ring.returnBuf(buf_id);
+        PinnedSendPermits().release();
+
+        if (result >= 0)
+        {
+            LOG_DEBUG("📤 데이터 전송 완료: 세션 {} - {} bytes (수신 버퍼 {})", session_id_, result, buf_id);
+        }
+        else
+        {
+            LOG_ERROR("❌데이터 전송 실패: 세션 {} - error code {}", session_id_, result);
+        }
+    }
+
     // SessionManager 구현
     SessionManager &SessionManager::GetInstance() noexcept
     {
@@ -91,71 +168,107 @@ namespace co_uring
         return instance;
     }
 
-    std::string SessionManager::AddSession(std::unique_ptr<socket_client> client)
+    task<std::string> SessionManager::AddSession(std::unique_ptr<socket_client> client)
     {
-        std::unique_lock lock{mutex_};
-
         std::string session_id = GenerateSessionId();
         auto session = std::make_shared<GameSession>(std::move(client), session_id);
-        sessions_[session_id] = session;
+
+        auto lock = co_await mutex_.scoped_lock();
+        sessions_[session_id] = std::move(session);
+        session_count_.store(sessions_.size(), std::memory_order_relaxed);
 
         LOG_INFO("✨ 새 세션 생성: {} (총 세션 수: {})", session_id, sessions_.size());
-        return session_id;
+        co_return session_id;
     }
 
-    std::shared_ptr<GameSession> SessionManager::GetSession(const std::string &session_id)
+    task<std::shared_ptr<GameSession>> SessionManager::GetSession(std::string session_id)
     {
-        std::shared_lock lock{mutex_};
+        auto lock = co_await mutex_.scoped_lock();
 
         if (auto it = sessions_.find(session_id); it != sessions_.end())
         {
-            return it->second;
+            co_return it->second;
         }
-        return nullptr;
+        co_return nullptr;
     }
 
-    void SessionManager::RemoveSession(const std::string &session_id)
+    task<void> SessionManager::RemoveSession(std::string session_id)
     {
-        std::unique_lock lock{mutex_};
+        auto lock = co_await mutex_.scoped_lock();
 
         if (auto it = sessions_.find(session_id); it != sessions_.end())
         {
             LOG_INFO("🗑️ 세션 제거: {} (남은 세션 수: {})", session_id, sessions_.size() - 1);
             sessions_.erase(it);
+            session_count_.store(sessions_.size(), std::memory_order_relaxed);
         }
     }
 
-    void SessionManager::CleanupExpiredSessions()
+    task<void> SessionManager::ReceiveLoop(GameSession &session, socket_client::recv_stream &stream)
     {
-        std::unique_lock lock{mutex_};
-
-        auto now = std::chrono::steady_clock::now();
-        size_t removed_count = 0;
+        const auto &session_id = session.GetSessionId();
+        auto &socket = session.GetSocket();
+        auto &buffer_ring = BufferRing::getInstance();
+        std::uint32_t chunks_since_yield = 0;
 
-        for (auto it = sessions_.begin(); it != sessions_.end();)
+        while (socket.is_valid())
         {
-            if (it->second->IsExpired())
+            // 수신 폭주 시 쌓인 청크는 중단 없이 바로 이어지므로 주기적으로 양보
+            if (++chunks_since_yield == CHUNKS_PER_YIELD)
             {
-                LOG_INFO("⏰ 만료된 세션 정리: {}", it->first);
-                it = sessions_.erase(it);
-                ++removed_count;
+                chunks_since_yield = 0;
+                co_await yield();
             }
-            else
+
+            // 청크는 이 루프 안에서만 꺼내므로 취소되더라도 받은 데이터가 버려지지 않음
+            // (남은 청크의 버퍼는 stream 소멸 시 반환)
+            auto chunk = co_await stream.next();
+
+            if (chunk.result == -ECANCELED)
             {
-                ++it;
+                // 유휴 마감이 먼저 끝나 취소됨
+                break;
             }
-        }
 
-        if (removed_count > 0)
-        {
-            LOG_INFO("🧹 세션 정리 완료: {} 개 세션 제거", removed_count);
+            if (chunk.result < 0)
+            {
+                LOG_WARN("⚠️ 수신 오류: 세션 {} - error code {}", session_id, chunk.result);
+                break;
+            }
+
+            if (chunk.result == 0)
+            {
+                LOG_INFO("🔌 클라이언트 연결 종료: 세션 {}", session_id);
+                break;
+            }
+
+            // 유휴 마감은 이 시각을 기준으로 다시 잡힘
+            session.UpdateHeartbeat();
+
+            // 버퍼 링에서 데이터 가져오기 (recv bundle이면 버퍼 여러 개를 한 번에 순회)
+            buffer_ring.forEachSlice(chunk.buffer_id, chunk.offset, chunk.length, chunk.buffer_count,
+                                     [&](std::span<std::uint8_t> buffer_data)
+                                     { session.OnRecvData(buffer_data.data(), buffer_data.size()); });
+            buffer_ring.returnBufs(chunk.buffer_id, chunk.buffer_count);
         }
     }
 
-    std::size_t SessionManager::GetActiveSessionCount() const noexcept
+    task<void> SessionManager::IdleDeadline(const GameSession &session)
     {
-        std::shared_lock lock{mutex_};
-        return sessions_.size();
+        // 수신마다 타이머를 다시 걸지 않고, 깨어났을 때 마지막 수신 시각으로 마감을 뒤로 미룸.
+        // 유휴 구간마다 타임아웃 SQE는 하나뿐이고 취소는 세션이 끝날 때 한 번
+        while (true)
+        {
+            const auto deadline = session.GetLastHeartbeat() + RECV_IDLE_TIMEOUT;
+            if (co_await sleep_until(deadline) == -ECANCELED)
+            {
+                co_return;
+            }
+            if (CoarseClock::getInstance().now() >= session.GetLastHeartbeat() + RECV_IDLE_TIMEOUT)
+            {
+                co_return;
+            }
+        }
     }
 
     task<void> SessionManager::HandleSession(std::shared_ptr<GameSession> session)
@@ -173,36 +286,14 @@ namespace co_uring
         {
             session->OnConnected();
 
-            auto &socket = session->GetSocket();
-
-            while (session && socket.is_valid())
+            // multishot recv 한 번으로 패킷마다 다시 제출하지 않고 계속 수신. 유휴 판정은 대기마다 타이머를
+            // 걸지 않고 세션당 마감 시각 하나로 하며, 수신 루프가 먼저 끝나면 마감 타이머는 취소됨
+            auto stream = session->GetSocket().recv_multishot();
+            auto finished = co_await when_any(ReceiveLoop(*session, stream), IdleDeadline(*session));
+            if (finished.index() == 1)
             {
-                auto recv_result = co_await socket.recv();
-
-                if (recv_result < 0)
-                {
-                    LOG_WARN("⚠️ 수신 오류: 세션 {} - error code {}", session_id, recv_result);
-                    break;
-                }
-
-                if (recv_result == 0)
-                {
-                    LOG_INFO("🔌 클라이언트 연결 종료: 세션 {}", session_id);
-                    break;
-                }
-
-                // 버퍼 링에서 데이터 가져오기
-                auto &buffer_ring = BufferRing::getInstance();
-                auto recv_awaiter = socket.recv();
-                auto buffer_id = recv_awaiter.get_buffer_id();
-                auto buffer_size = recv_awaiter.get_buffer_size();
-
-                auto& buffer_data = buffer_ring.borrowBuf(buffer_id);
-                            if (!buffer_data.empty() && buffer_size > 0)
-            {
-                session->OnRecvData(buffer_data.data(), buffer_size);
-                buffer_ring.returnBuf(buffer_id);
-            }
+                LOG_INFO("⏰ 유휴 시간 초과로 세션 종료: 세션 {} ({}초 동안 수신 없음)", session_id,
+                         RECV_IDLE_TIMEOUT.count());
             }
         }
         catch (const std::exception &e)
@@ -211,16 +302,16 @@ namespace co_uring
         }
 
         session->OnDisconnected();
-        RemoveSession(session_id);
+        co_await RemoveSession(session_id);
 
         LOG_INFO("🔚 세션 처리 종료: {}", session_id);
     }
 
     std::string SessionManager::GenerateSessionId()
     {
-        static std::random_device rd;
-        static std::mt19937 gen{rd()};
-        static std::uniform_int_distribution<> dis{0, 15};
+        // AddSession은 잠금 밖에서 여러 워커가 동시에 부르므로 생성기는 스레드마다 따로 둠
+        thread_local std::mt19937 gen{std::random_device{}()};
+        thread_local std::uniform_int_distribution<> dis{0, 15};
         static const char *chars = "0123456789ABCDEF";
 
         std::string id;
@@ -242,8 +333,8 @@ namespace co_uring
         }
 
         auto &session_manager = SessionManager::GetInstance();
-        auto session_id = session_manager.AddSession(std::move(client));
-        auto session = session_manager.GetSession(session_id);
+        auto session_id = co_await session_manager.AddSession(std::move(client));
+        auto session = co_await session_manager.GetSession(session_id);
 
         if (session)
         {
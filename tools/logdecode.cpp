@@ -0,0 +1,245 @@
+// Turns binary logs (LogBackendOptions::format = LogFormat::BINARY) back into the text
+// log format, one line per record.
+//
+// Usage: ./logdecode [--color] [file...]
+//
+// Files are decoded in order, stdin when none are given. Rotated files each start with
+// their own header and descriptors, so any one of them decodes on its own.
+
+#include "io/include/binary_log.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace co_uring;
+
+namespace
+{
+
+    class decoder
+    {
+    public:
+        explicit decoder(bool color) : color_(color) {}
+
+        // False if the data ends in the middle of a record or is not a binary log
+        bool decode(std::string_view data, const char *name)
+        {
+            binlog::cursor in{data};
+            while (!in.empty())
+            {
+                const std::size_t offset = in.consumed(data);
+                char type = 0;
+                in.read(type);
+                bool ok = false;
+                switch (type)
+                {
+                case binlog::HEADER:
+                    ok = header(in);
+                    break;
+                case binlog::DESCRIPTOR:
+                    ok = descriptor(in);
+                    break;
+                case binlog::CLOCK:
+                    ok = in.read(clock_.ticks) && in.read(clock_.unix_ns) && in.read(clock_.ticks_per_ns);
+                    break;
+                case binlog::EVENT:
+                    ok = event(in);
+                    break;
+                case binlog::TEXT:
+                    ok = text(in);
+                    break;
+                default:
+                    break;
+                }
+                if (!ok)
+                {
+                    flush();
+                    std::fprintf(stderr, "%s: %s record at offset %zu\n", name,
+                                 type == 0 || std::strchr("HDCET", type) == nullptr ? "unknown" : "truncated or corrupt",
+                                 offset);
+                    return false;
+                }
+                if (out_.size() >= 64 * 1024)
+                {
+                    flush();
+                }
+            }
+            flush();
+            return true;
+        }
+
+    private:
+        bool header(binlog::cursor &in)
+        {
+            std::string_view magic;
+            if (!in.readBytes(sizeof(binlog::MAGIC), magic) ||
+                magic != std::string_view(binlog::MAGIC, sizeof(binlog::MAGIC)))
+            {
+                return false;
+            }
+            // Site ids are per file
+            sites_.clear();
+            return true;
+        }
+
+        bool descriptor(binlog::cursor &in)
+        {
+            binlog::descriptor site;
+            std::string_view file, func, format, types;
+            if (!in.read(site.id) || !in.read(site.level) || !in.read(site.line) || !in.readString(file) ||
+                !in.readString(func) || !in.readString(format) || !in.readString<std::uint8_t>(types))
+            {
+                return false;
+            }
+            // The writer numbers sites from 1 and describes them in order, so an id far past
+            // the ones seen so far means a corrupt file, not a sparse table
+            if (site.id == 0 || site.id > sites_.size() + MAX_SITE_GAP)
+            {
+                return false;
+            }
+            site.file = file;
+            site.func = func;
+            site.format = format;
+            site.types = types;
+            if (sites_.size() < site.id)
+            {
+                sites_.resize(site.id);
+            }
+            sites_[site.id - 1] = std::move(site);
+            return true;
+        }
+
+        bool event(binlog::cursor &in)
+        {
+            std::uint32_t id = 0;
+            std::uint64_t ticks = 0;
+            std::string_view thread, payload;
+            if (!in.read(id) || !in.read(ticks) || !in.readBytes(binlog::THREAD_TAG, thread) || !in.readString(payload))
+            {
+                return false;
+            }
+
+            const std::int64_t unix_ns = clock_.toUnixNanos(ticks);
+            message_.clear();
+            if (id == 0 || id > sites_.size() || sites_[id - 1].id == 0)
+            {
+                message_ = "<unknown log site " + std::to_string(id) + ">";
+                emit(unix_ns, UNKNOWN_SITE_LEVEL, thread, {}, 0, {}, message_);
+            }
+            else
+            {
+                const binlog::descriptor &site = sites_[id - 1];
+                binlog::formatPayload(message_, site.format, site.types, payload);
+                emit(unix_ns, site.level, thread, site.file, static_cast<std::int32_t>(site.line), site.func,
+                     message_);
+            }
+            return true;
+        }
+
+        bool text(binlog::cursor &in)
+        {
+            std::uint8_t level = 0;
+            std::int64_t unix_ns = 0;
+            std::uint32_t line = 0;
+            std::string_view thread, file, func, message;
+            if (!in.read(level) || !in.read(unix_ns) || !in.readBytes(binlog::THREAD_TAG, thread) ||
+                !in.readString(file) || !in.read(line) || !in.readString(func) || !in.readString(message))
+            {
+                return false;
+            }
+
+            emit(unix_ns, level, thread, file, static_cast<std::int32_t>(line), func, message);
+            return true;
+        }
+
+        // Same line the text log would have had
+        void emit(std::int64_t unix_ns, std::uint8_t level, std::string_view thread, std::string_view file,
+                  std::int32_t line, std::string_view func, std::string_view message)
+        {
+            char timestamp[binlog::TIMESTAMP_LENGTH];
+            binlog::formatTimestamp(unix_ns, timestamp);
+            binlog::appendLine(out_, std::string_view(timestamp, sizeof(timestamp)), level, trim(thread), file, line,
+                               func, message, color_);
+        }
+
+        static std::string_view trim(std::string_view thread)
+        {
+            while (!thread.empty() && (thread.back() == ' ' || thread.back() == '\0'))
+            {
+                thread.remove_suffix(1);
+            }
+            return thread;
+        }
+
+        void flush()
+        {
+            std::fwrite(out_.data(), 1, out_.size(), stdout);
+            out_.clear();
+        }
+
+        // How far a descriptor id may run ahead of the ones already read
+        static constexpr std::size_t MAX_SITE_GAP = 1024;
+        // LogLevel::WARN, for events whose descriptor is missing
+        static constexpr std::uint8_t UNKNOWN_SITE_LEVEL = 2;
+
+        const bool color_;
+        std::vector<binlog::descriptor> sites_;
+        binlog::clock_sync clock_;
+        std::string message_;
+        std::string out_;
+    };
+
+    std::string readAll(std::istream &in)
+    {
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool color = false;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--color") == 0)
+        {
+            color = true;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+
+    int status = 0;
+    if (files.empty())
+    {
+        const std::string data = readAll(std::cin);
+        decoder d{color};
+        status = d.decode(data, "<stdin>") ? 0 : 1;
+    }
+    for (const char *name : files)
+    {
+        std::ifstream in(name, std::ios::binary);
+        if (!in)
+        {
+            std::fprintf(stderr, "%s: cannot open\n", name);
+            status = 1;
+            continue;
+        }
+        const std::string data = readAll(in);
+        decoder d{color};
+        if (!d.decode(data, name))
+        {
+            status = 1;
+        }
+    }
+    return status;
+}